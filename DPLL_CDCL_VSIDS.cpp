@@ -1,497 +1,739 @@
-// DPLL + CDCL + VSIDS
-
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <unordered_set>
-#include <unordered_map>
-#include <string>
-#include <cstdlib>
-#include <algorithm>
-#include <chrono>
-#include <iomanip>
-#include <filesystem>
-
-#if defined(_WIN32) || defined(_WIN64)
-#include <windows.h>
-#include <psapi.h>
-double get_memory_usage() {
-    PROCESS_MEMORY_COUNTERS memCounters;
-    if (GetProcessMemoryInfo(GetCurrentProcess(), &memCounters, sizeof(memCounters))) {
-        return memCounters.WorkingSetSize / (1024.0); // bytes to KB
-    }
-    return 0.0;
-}
-#elif defined(__linux__)
-#include <unistd.h>
-double get_memory_usage() {
-    std::ifstream status_file("/proc/" + std::to_string(getpid()) + "/status");
-    std::string line;
-    while (std::getline(status_file, line)) {
-        if (line.find("VmRSS:") == 0) {
-            std::stringstream ss(line.substr(6));
-            long long memory_kb;
-            ss >> memory_kb;
-            return (memory_kb);     // already in KB
-        }
-    }
-    std::cerr << "Error: Could not read VmRSS from /proc/self/status on Linux." << std::endl;
-    return -1;
-}
-#else
-double getMemoryUsage() {
-    std::cerr << "Error: Memory usage measurement is not implemented for this platform." << std::endl;
-    return -1;
-}
-#endif
-
-using namespace std;
-
-// Structure to hold variable information.
-struct VariableInfo {
-    // value: -1 means unassigned; 1 means True; 0 means False.
-    int value;
-    vector<int> positive_clauses;
-    vector<int> negative_clauses;
-    double pos_count;
-    double neg_count;
-    VariableInfo() : value(-1), pos_count(0.0), neg_count(0.0) {}
-};
-
-// Structure for assignment status (used for conflict analysis).
-struct AssignmentStatus {
-    bool conflict;
-    unordered_set<int> reason;
-    AssignmentStatus() : conflict(false) {}
-};
-
-class DPLLSolver_DS {
-public:
-    // Data members
-vector<unordered_set<int>> cnf;                  // Dynamic CNF (clauses updated during search)
-    vector<unordered_set<int>> original_cnf;     // Original CNF (learned clauses added here)
-    vector<VariableInfo> variables;              // Indexed by variable number (1-indexed; index 0 unused)
-    vector<int> assignments_stack;               // Stack of current assignments (literals)
-    unordered_set<int> unsatisfied_clauses;      // Set of clause indices that are not yet satisfied
-
-    AssignmentStatus last_assignment_status;
-
-    int max_learned_clause_len;
-    int max_learned_clauses;
-    int learned_clauses_count;
-    double decay_factor;
-    double conflict_weight;
-    int decay_interval;
-    int decision_count;
-
-    // Constructor: cnf_clauses is a vector of clauses (each clause is a set of literals)
-    DPLLSolver_DS(const vector<unordered_set<int>>& cnf_clauses,
-                  int learned_clause_limit_percentage = 25,
-                  int max_learned_clause_len_param = 5)
-        : max_learned_clause_len(max_learned_clause_len_param + 1),
-          learned_clauses_count(0),
-          decay_factor(0.95),
-          conflict_weight(0.2),
-          decay_interval(10),
-          decision_count(0)
-    {
-        // Copy input clauses
-        for (const auto& clause : cnf_clauses) {
-            cnf.push_back(clause);
-            original_cnf.push_back(clause);
-        }
-        // Initially, all clauses are unsatisfied.
-        for (int i = 0; i < (int)cnf.size(); i++) {
-            unsatisfied_clauses.insert(i);
-        }
-        // Determine maximum variable number.
-        int maxVar = 0;
-        for (const auto& clause : cnf_clauses) {
-            for (int lit : clause) {
-                maxVar = max(maxVar, abs(lit));
-            }
-        }
-        // Resize variables vector (index 0 unused).
-        variables.resize(maxVar + 1);
-        // Populate clause lists for each variable.
-        for (size_t i = 0; i < cnf_clauses.size(); i++) {
-            for (int lit : cnf_clauses[i]) {
-                int var = abs(lit);
-                if (lit > 0)
-                    variables[var].positive_clauses.push_back(i);
-                else
-                    variables[var].negative_clauses.push_back(i);
-            }
-        }
-        // Maximum learned clauses allowed.
-        max_learned_clauses = (int)(cnf_clauses.size() * (learned_clause_limit_percentage / 100.0));
-    }
-
-    // Public solve method.
-    bool solve() {
-        assignments_stack.clear();
-        return dpll();
-    }
-
-    // Print assignments in sorted order.
-    void print_assignments() {
-        cout << "ASSIGNMENT: ";
-        for (size_t i = 1; i < variables.size(); i++) {
-            if (variables[i].value != -1) {
-                cout << i << "=" << variables[i].value << " ";
-            }
-        }
-        cout << "\n";
-    }
-
-    // Get current assignments as a map.
-    unordered_map<int, int> get_assignments() {
-        unordered_map<int, int> assignments;
-        for (size_t i = 1; i < variables.size(); i++) {
-            if (variables[i].value != -1)
-                assignments[i] = (variables[i].value == 1 ? 1 : 0);
-        }
-        return assignments;
-    }
-
-private:
-    // The main recursive DPLL algorithm.
-    bool dpll() {
-        decision_count++;
-        if (decision_count % decay_interval == 0) {
-            decision_count = 0;
-            decay_counters();
-        }
-
-        // Unit Clause Propagation
-        vector<int> unit_clauses;
-        for (int idx : unsatisfied_clauses) {
-            if (cnf[idx].size() == 1)
-                unit_clauses.push_back(idx);
-        }
-        while (!unit_clauses.empty()) {
-            int idx = unit_clauses.back();
-            unit_clauses.pop_back();
-            if (cnf[idx].empty()) continue;
-            int unit = *(cnf[idx].begin());
-            if (!assign(unit)) {
-                if (last_assignment_status.conflict && last_assignment_status.reason.size() < (size_t)max_learned_clause_len)
-                    add_learned_clause(last_assignment_status.reason);
-                unassign(unit);
-                return false;
-            }
-            assignments_stack.push_back(unit);
-            unsatisfied_clauses.erase(idx);
-            // Recompute unit clauses after propagation.
-            unit_clauses.clear();
-            for (int j : unsatisfied_clauses) {
-                if (cnf[j].size() == 1)
-                    unit_clauses.push_back(j);
-            }
-        }
-        if (unsatisfied_clauses.empty())
-            return true;
-
-        // Pure Literal Elimination
-        while (true) {
-            unordered_set<int> pure_literals = find_pure_literals();
-            if (pure_literals.empty())
-                break;
-            for (int lit : pure_literals) {
-                if (!assign(lit)) {
-                    unassign(lit);
-                    return false;
-                }
-                assignments_stack.push_back(lit);
-            }
-        }
-        if (unsatisfied_clauses.empty())
-            return true;
-
-        // Branching: choose a literal based on VSIDS frequency.
-        int branch_lit = vsids_frequent_literal();
-        if (branch_lit == 0)
-            return unsatisfied_clauses.empty();
-
-        // Try assigning branch_lit and then its negation with backtracking.
-        for (int val : {branch_lit, -branch_lit}) {
-            if (assign(val)) {
-                assignments_stack.push_back(val);
-                size_t last_stack_length = assignments_stack.size();
-                if (dpll())
-                    return true;
-                // Backtrack: unassign all assignments added in the recursive call.
-                while (assignments_stack.size() >= last_stack_length) {
-                    int popped = assignments_stack.back();
-                    assignments_stack.pop_back();
-                    unassign(popped);
-                }
-                unassign(val);
-            } else {
-                if (last_assignment_status.conflict && last_assignment_status.reason.size() < (size_t)max_learned_clause_len) {
-                    add_learned_clause(last_assignment_status.reason);
-                    unassign(val);
-                    return false;
-                }
-                unassign(val);
-            }
-        }
-        return false;
-    }
-
-    // Find pure literals that appear with only one polarity.
-    unordered_set<int> find_pure_literals() {
-        unordered_map<int, int> candidate_literals;
-        for (int idx : unsatisfied_clauses) {
-            for (int lit : cnf[idx]) {
-                candidate_literals[lit]++;
-            }
-        }
-        unordered_set<int> pure;
-        for (const auto& p : candidate_literals) {
-            int lit = p.first;
-            if (candidate_literals.find(-lit) == candidate_literals.end() && variables[abs(lit)].value == -1)
-                pure.insert(lit);
-        }
-        return pure;
-    }
-
-    // VSIDS: select the most frequently occurring unassigned literal.
-    int vsids_frequent_literal() {
-        if (unsatisfied_clauses.empty())
-            return 0;
-        unordered_map<int, double> literal_counts;
-        for (int idx : unsatisfied_clauses) {
-            for (int lit : cnf[idx]) {
-                if (variables[abs(lit)].value == -1) {
-                    double weight = 1.0 + (lit > 0 ? variables[abs(lit)].pos_count : variables[abs(lit)].neg_count);
-                    literal_counts[lit] += weight;
-                }
-            }
-        }
-        if (literal_counts.empty())
-            return 0;
-        int best_literal = 0;
-        double best_count = -1;
-        for (const auto& p : literal_counts) {
-            if (p.second > best_count) {
-                best_count = p.second;
-                best_literal = p.first;
-            }
-        }
-        return best_literal;
-    }
-
-    // Try to assign a literal and update affected clauses.
-    bool assign(int literal) {
-        int var = abs(literal);
-        // Reset conflict status.
-        last_assignment_status.conflict = false;
-        last_assignment_status.reason.clear();
-
-        // If already assigned, check for consistency.
-        if (variables[var].value != -1) {
-            if (variables[var].value == (literal > 0 ? 1 : 0))
-                return true;
-            else
-                return false;
-        }
-        // Set the assignment.
-        variables[var].value = (literal > 0 ? 1 : 0);
-
-        int count = 0;
-        unordered_set<int> conflict_clause;
-
-        // Process clauses where the literal appears in the satisfied polarity.
-        vector<int>& clauseList = (literal > 0 ? variables[var].positive_clauses : variables[var].negative_clauses);
-        for (int idx : clauseList) {
-            if (unsatisfied_clauses.find(idx) != unsatisfied_clauses.end()) {
-                bool all_assigned_false = true;
-                for (int lit : original_cnf[idx]) {
-                    if (lit == literal) continue;
-                    int assigned = variables[abs(lit)].value;
-                    if (assigned == -1) { all_assigned_false = false; break; }
-                    int required = (lit < 0 ? 1 : 0);
-                    if (assigned != required) { all_assigned_false = false; break; }
-                }
-                if (all_assigned_false && count == 0) {
-                    count = 1;
-                    for (int lit : original_cnf[idx]) {
-                        int required = (lit < 0 ? 1 : 0);
-                        if (variables[abs(lit)].value == required)
-                            conflict_clause.insert(lit);
-                    }
-                }
-                unsatisfied_clauses.erase(idx);
-            }
-        }
-        // Process clauses where the literal appears in the opposite polarity.
-        vector<int>& clauseList2 = (literal > 0 ? variables[var].negative_clauses : variables[var].positive_clauses);
-        for (int idx : clauseList2) {
-            if (unsatisfied_clauses.find(idx) != unsatisfied_clauses.end()) {
-                if (cnf[idx].size() == 1 && count == 1) {
-                    for (int lit : original_cnf[idx]) {
-                        if (lit != -literal)
-                            conflict_clause.insert(lit);
-                    }
-                    last_assignment_status.conflict = true;
-                    last_assignment_status.reason = conflict_clause;
-                    variables[var].value = -1;  // revert assignment
-                    return false;
-                }
-                // Remove the literal that is now false.
-                cnf[idx].erase(-literal);
-            }
-        }
-        return true;
-    }
-
-    // Revert the assignment of a literal and restore the affected clauses.
-    void unassign(int literal) {
-        int var = abs(literal);
-        variables[var].value = -1;
-        vector<int>& clauses_with_negative = (literal > 0 ? variables[var].negative_clauses : variables[var].positive_clauses);
-        vector<int>& clauses_with_chosen = (literal > 0 ? variables[var].positive_clauses : variables[var].negative_clauses);
-        for (int idx : clauses_with_negative) {
-            cnf[idx].insert(-literal);
-        }
-        for (int idx : clauses_with_chosen) {
-            if (!is_clause_satisfied(idx))
-                unsatisfied_clauses.insert(idx);
-        }
-    }
-
-    // Check if a clause is satisfied.
-    bool is_clause_satisfied(int clause_index) {
-        for (int lit : cnf[clause_index]) {
-            int var = abs(lit);
-            if (variables[var].value != -1) {
-                int required = (lit > 0 ? 1 : 0);
-                if (variables[var].value == required)
-                    return true;
-            }
-        }
-        return false;
-    }
-
-    // Add a learned clause derived from a conflict.
-    void add_learned_clause(const unordered_set<int>& learned_clause) {
-        if (learned_clause.empty())
-            return;
-        if (learned_clauses_count >= max_learned_clauses)
-            return;
-        unordered_set<int> new_clause;
-        for (int lit : learned_clause) {
-            int var = abs(lit);
-            if (variables[var].value == -1 || variables[var].value == (lit > 0 ? 1 : 0))
-                new_clause.insert(lit);
-        }
-        unordered_set<int> new_clause_original = learned_clause; // copy original learned clause
-        original_cnf.push_back(new_clause_original);
-        cnf.push_back(new_clause);
-        int learned_clause_index = cnf.size() - 1;
-        unsatisfied_clauses.insert(learned_clause_index);
-        // Update variable clause lists.
-        for (int lit : new_clause_original) {
-            int var = abs(lit);
-            if (lit > 0)
-                variables[var].positive_clauses.push_back(learned_clause_index);
-            else
-                variables[var].negative_clauses.push_back(learned_clause_index);
-        }
-        learned_clauses_count++;
-        boost_conflict_literals(learned_clause);
-    }
-
-    // Decay the conflict counters.
-    void decay_counters() {
-        for (auto& var : variables) {
-            var.pos_count *= decay_factor;
-            var.neg_count *= decay_factor;
-        }
-    }
-
-    // Boost the counters for conflict literals.
-    void boost_conflict_literals(const unordered_set<int>& conflict_clause) {
-        for (int lit : conflict_clause) {
-            int var = abs(lit);
-            if (lit > 0)
-                variables[var].pos_count += conflict_weight;
-            else
-                variables[var].neg_count += conflict_weight;
-        }
-        decay_counters();
-    }
-};
-
-// Helper function to load a CNF file and parse the clauses.
-vector<unordered_set<int>> load_cnf(const string& filename) {
-    ifstream infile(filename);
-    string line;
-    vector<unordered_set<int>> clauses;
-    while (getline(infile, line)) {
-        if (line.empty() || line[0] == 'c' || line[0] == 'p' ||
-            line[0] == '%' || line[0] == '0')
-            continue;
-        istringstream iss(line);
-        int lit;
-        vector<int> lits;
-        while (iss >> lit) {
-            lits.push_back(lit);
-        }
-        // The last element is typically 0 and omitted.
-        unordered_set<int> clause;
-        for (size_t i = 0; i < lits.size() - 1; i++) {
-            clause.insert(lits[i]);
-        }
-        clauses.push_back(clause);
-    }
-    if (clauses.empty())
-    {
-        throw runtime_error("Error: No valid clauses found in CNF file.");
-    }
-    return clauses;
-}
-
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        cout << "Usage: ./DPLL_CDCL_VSIDS <cnf_file>\n";
-        return 1;
-    }
-
-    try
-    {
-        string file_path = argv[1];
-        if (file_path.size() < 4 || file_path.substr(file_path.size() - 4) != ".cnf" || !std::filesystem::exists(file_path))
-        {
-            cerr << "Error: Input file must be a valid .cnf file and must exist.\n";
-            return 1;
-        }
-
-        vector<unordered_set<int>> clauses = load_cnf(file_path);
-        DPLLSolver_DS solver(clauses);
-
-        auto start_time = chrono::high_resolution_clock::now();
-        bool result = solver.solve();
-        auto end_time = chrono::high_resolution_clock::now();
-        chrono::duration<double> time_taken = end_time - start_time;
-        double memory_used = get_memory_usage();
-
-        cout << "[DPLL + CDCL + VSIDS]\nRESULT: " << (result ? "SAT" : "UNSAT") << "\n";
-        if (result)
-            solver.print_assignments();
-        std::cout << std::fixed << std::setprecision(7);
-        cout << "Time taken: " << time_taken.count() << " seconds\n";
-        // Reset formatting to default for memory output
-        std::cout.unsetf(std::ios_base::floatfield);
-        cout << "Memory used: " << memory_used << " KB\n";
-    }
-    catch (const exception& e)
-    {
-        cerr << e.what() << "\n";
-        return 1;
-    }
-
-    return 0;
-}
+// DPLL + CDCL + VSIDS
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <string>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <filesystem>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <new>
+#include "solver.h"
+#include "profile.h"
+#include "formats.h"
+#include "daemon.h"
+
+using namespace std;
+
+// A finite number spelled out in full, at least min_value.
+bool parse_number(const char* text, double min_value, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !isfinite(parsed) || parsed < min_value)
+        return false;
+    value = parsed;
+    return true;
+}
+
+// A decimal integer spelled out in full, in [min_value, max_value].
+template <class Integer>
+bool parse_integer(const char* text, Integer min_value, Integer max_value, Integer& value) {
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < (long long)min_value || parsed > (long long)max_value)
+        return false;
+    value = (Integer)parsed;
+    return true;
+}
+
+// Nearest-neighbour algorithm selection over instance_features(). The model file, as
+// written by train_selector.py, names the candidate configurations (each a set of
+// parameter overrides) and holds one point per training instance: its features and the
+// PAR2 cost of every configuration on it. A new instance ranks the configurations by
+// their mean log cost, relative to the best, over the k nearest training points in
+// standardised feature space.
+//
+//   features <name>...            center <mean>...            scale <stddev>...
+//   k <neighbours>                config <name> [<parameter>=<value>]...
+//   point <feature>... <cost per config>...
+class AlgorithmSelector {
+public:
+    explicit AlgorithmSelector(const string& path) : neighbours(5) {
+        ifstream in(path);
+        if (!in)
+            throw runtime_error("Error: Cannot open selector model " + path + ".");
+        string line;
+        while (getline(in, line)) {
+            istringstream fields(line.substr(0, line.find('#')));
+            string keyword, token;
+            if (!(fields >> keyword))
+                continue;
+            if (keyword == "features") {
+                while (fields >> token)
+                    feature_names.push_back(token);
+            } else if (keyword == "center" || keyword == "scale" || keyword == "point") {
+                vector<double> values;
+                double value;
+                while (fields >> value)
+                    values.push_back(value);
+                (keyword == "center" ? center : keyword == "scale" ? scale : points).push_back(values);
+            } else if (keyword == "k") {
+                fields >> neighbours;
+            } else if (keyword == "config") {
+                Configuration config;
+                fields >> config.name;
+                while (fields >> token) {
+                    size_t eq = token.find('=');
+                    double value;
+                    if (eq == string::npos || !parse_number(token.c_str() + eq + 1, -HUGE_VAL, value))
+                        throw runtime_error("Error: Malformed configuration in selector model " + path + ".");
+                    config.overrides.emplace_back(token.substr(0, eq), value);
+                }
+                configs.push_back(config);
+            } else {
+                throw runtime_error("Error: Unknown line '" + keyword + "' in selector model " + path + ".");
+            }
+        }
+        size_t n = feature_names.size();
+        bool valid = !configs.empty() && center.size() == 1 && scale.size() == 1 &&
+                     center[0].size() == n && scale[0].size() == n && neighbours > 0;
+        for (const auto& point : points)
+            valid = valid && point.size() == n + configs.size();
+        if (!valid)
+            throw runtime_error("Error: Selector model " + path + " is incomplete or inconsistent.");
+    }
+
+    size_t size() const { return configs.size(); }
+    const string& name(size_t config) const { return configs[config].name; }
+
+    // Configurations best first for an instance with these features (as returned by
+    // instance_features(), which must list the model's features in the same order).
+    vector<size_t> rank(const vector<pair<string, double>>& features) const {
+        size_t n = feature_names.size();
+        vector<double> x(n);
+        for (size_t i = 0; i < n; i++) {
+            if (i >= features.size() || features[i].first != feature_names[i])
+                throw runtime_error("Error: Selector model features do not match this solver.");
+            x[i] = standardise(features[i].second, i);
+        }
+        vector<pair<double, size_t>> by_distance;
+        for (size_t p = 0; p < points.size(); p++) {
+            double distance = 0;
+            for (size_t i = 0; i < n; i++) {
+                double d = x[i] - standardise(points[p][i], i);
+                distance += d * d;
+            }
+            by_distance.emplace_back(distance, p);
+        }
+        size_t k = min(by_distance.size(), (size_t)neighbours);
+        partial_sort(by_distance.begin(), by_distance.begin() + k, by_distance.end());
+        vector<double> score(configs.size(), 0.0);
+        for (size_t j = 0; j < k; j++) {
+            const vector<double>& point = points[by_distance[j].second];
+            double best = *min_element(point.begin() + n, point.end());
+            for (size_t c = 0; c < configs.size(); c++)
+                score[c] += log((point[n + c] + 0.01) / (best + 0.01));
+        }
+        vector<size_t> order(configs.size());
+        for (size_t c = 0; c < order.size(); c++)
+            order[c] = c;
+        stable_sort(order.begin(), order.end(), [&score](size_t a, size_t b) { return score[a] < score[b]; });
+        return order;
+    }
+
+    // Set the solver's parameters to base with the configuration's overrides on top.
+    void apply(size_t config, const vector<pair<string, double>>& base, DPLLSolver_DS& solver) const {
+        for (const auto& parameter : base)
+            solver.set_parameter(parameter.first, parameter.second);
+        for (const auto& parameter : configs[config].overrides) {
+            if (!solver.set_parameter(parameter.first, parameter.second))
+                throw runtime_error("Error: Selector configuration " + configs[config].name +
+                                    " sets unknown parameter or bad value for " + parameter.first + ".");
+        }
+    }
+
+private:
+    struct Configuration {
+        string name;
+        vector<pair<string, double>> overrides;
+    };
+
+    double standardise(double value, size_t feature) const {
+        return (value - center[0][feature]) / (scale[0][feature] > 0 ? scale[0][feature] : 1.0);
+    }
+
+    vector<string> feature_names;
+    vector<vector<double>> center;          // One row: training mean per feature
+    vector<vector<double>> scale;           // One row: training standard deviation per feature
+    vector<vector<double>> points;
+    vector<Configuration> configs;
+    int neighbours;
+};
+
+// Solve with a selector's ranking as a fallback schedule. Each configuration in rank
+// order runs for one time slice, keeping the clauses learned under the earlier ones;
+// then the first choice runs until the overall limits (as for set_limits(), -1 / <= 0
+// for none) stop it. engine is set to the configuration that was running at the end.
+SolveStatus solve_scheduled(DPLLSolver_DS& solver, const AlgorithmSelector& selector, double slice,
+                            long long conflict_limit, double time_limit, string& engine) {
+    vector<size_t> order = selector.rank(solver.instance_features());
+    vector<pair<string, double>> base;
+    for (const string& name : DPLLSolver_DS::parameter_names())
+        base.emplace_back(name, solver.get_parameter(name));
+    if (order.size() > 1)
+        order.push_back(order.front());
+    auto start = chrono::steady_clock::now();
+    long long start_conflicts = solver.conflicts;
+    SolveStatus status = SolveStatus::Unknown;
+    for (size_t step = 0; step < order.size(); step++) {
+        bool last = (step + 1 == order.size());
+        double remaining = time_limit - chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long long conflicts_left = conflict_limit - (solver.conflicts - start_conflicts);
+        if ((time_limit > 0 && remaining <= 0) || (conflict_limit >= 0 && conflicts_left <= 0))
+            break;
+        double seconds = (time_limit > 0 ? remaining : 0);
+        if (!last)
+            seconds = (seconds > 0 ? min(seconds, slice) : slice);
+        selector.apply(order[step], base, solver);
+        engine = selector.name(order[step]);
+        solver.set_limits(conflict_limit >= 0 ? conflicts_left : -1, seconds);
+        status = solver.solve_limited();
+        if (status != SolveStatus::Unknown)
+            break;
+    }
+    return status;
+}
+
+// Shrink the core of an unsatisfiable solve with core tracking until dropping any one
+// clause makes it satisfiable. Each trial drops one clause and solves the rest on a
+// fresh solver seeded with the derived clauses whose inputs all remain, so that what
+// earlier trials learned carries over. An unsatisfiable trial's own core, often much
+// smaller, replaces the current one; a satisfiable trial shows that the dropped clause
+// is needed. A trial stopped by the conflict limit (-1: none) keeps its clause, and
+// the result is then only an upper bound. trials is set to the number of trials run.
+vector<int> minimize_core(const DPLLSolver_DS& solver, long long trial_conflicts, int& trials) {
+    vector<int> core = solver.unsat_core();
+    vector<pair<vector<int>, vector<int>>> derived = solver.derived_clauses();
+    vector<char> needed(solver.input_clause_count(), 0);
+    vector<int> position(solver.input_clause_count(), -1);
+    trials = 0;
+    for (size_t next = 0; next < core.size();) {
+        int dropped = core[next];
+        if (needed[dropped]) {
+            next++;
+            continue;
+        }
+        vector<int> kept;
+        for (int id : core) {
+            if (id != dropped)
+                kept.push_back(id);
+        }
+        DPLLSolver_DS trial;
+        for (const string& name : DPLLSolver_DS::parameter_names())
+            trial.set_parameter(name, solver.get_parameter(name));
+        trial.track_core();
+        trial.declare_variables(solver.num_variables());
+        for (size_t i = 0; i < kept.size(); i++) {
+            const ClauseArena::Clause clause = solver.input_clause(kept[i]);
+            vector<int> lits(clause.begin(), clause.end());
+            trial.add_clause(lits.data(), lits.data() + lits.size());
+            position[kept[i]] = (int)i;
+        }
+        trial.finish_loading();
+        for (const auto& clause : derived) {
+            vector<int> inputs;
+            for (int id : clause.second) {
+                if (position[id] < 0)
+                    break;
+                inputs.push_back(position[id]);
+            }
+            if (inputs.size() == clause.second.size())
+                trial.add_derived_clause(clause.first, inputs);
+        }
+        for (int id : kept)
+            position[id] = -1;
+        trial.set_limits(trial_conflicts, 0);
+        trials++;
+        if (trial.solve_limited() != SolveStatus::Unsatisfiable) {
+            needed[dropped] = 1;
+            next++;
+            continue;
+        }
+        // Back to the caller's input ids.
+        core.clear();
+        for (int id : trial.unsat_core())
+            core.push_back(kept[id]);
+        derived = trial.derived_clauses();
+        for (auto& clause : derived) {
+            for (int& id : clause.second)
+                id = kept[id];
+        }
+        next = lower_bound(core.begin(), core.end(), dropped) - core.begin();
+    }
+    return core;
+}
+
+// Solve several formulas on the calling thread by round robin. Every unfinished solver
+// gets one step() of step_conflicts conflicts per round, so a hard formula holds up the
+// others by at most one step; each result is printed as soon as it is known. A time
+// limit (<= 0 for none) covers the whole run, and formulas still open then are reported
+// as UNKNOWN. Returns false if any formula stays unsolved.
+bool solve_multiplexed(vector<unique_ptr<DPLLSolver_DS>>& solvers, const vector<string>& names,
+                       long long step_conflicts, double time_limit) {
+    auto start = chrono::steady_clock::now();
+    vector<long long> steps(solvers.size(), 0);
+    vector<size_t> open;
+    for (size_t i = 0; i < solvers.size(); i++)
+        open.push_back(i);
+    auto report = [&](size_t i, SolveStatus status) {
+        cout << names[i] << ": "
+             << (status == SolveStatus::Satisfiable ? "SAT" : status == SolveStatus::Unsatisfiable ? "UNSAT" : "UNKNOWN")
+             << " steps=" << steps[i] << " conflicts=" << solvers[i]->conflicts << "\n";
+        if (status == SolveStatus::Satisfiable) {
+            cout << "ASSIGNMENT: ";
+            for (int lit : solvers[i]->get_model())
+                cout << abs(lit) << "=" << (lit > 0 ? 1 : 0) << " ";
+            cout << "\n";
+        }
+        cout.flush();
+    };
+    while (!open.empty()) {
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (time_limit > 0 && elapsed >= time_limit)
+            break;
+        vector<size_t> still_open;
+        for (size_t i : open) {
+            // The deadline also bounds a single step, in case one runs long.
+            double remaining = time_limit - chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            solvers[i]->set_limits(-1, time_limit > 0 ? max(remaining, 1e-3) : 0);
+            SolveStatus status = solvers[i]->step(step_conflicts);
+            steps[i]++;
+            if (status == SolveStatus::Unknown)
+                still_open.push_back(i);
+            else
+                report(i, status);
+        }
+        open.swap(still_open);
+    }
+    for (size_t i : open)
+        report(i, SolveStatus::Unknown);
+    return open.empty();
+}
+
+int main(int argc, char* argv[]) {
+    string file_path;
+    string snapshot_path;
+    string resume_path;
+    double snapshot_interval = 60.0;
+    string cache_dir;
+    bool verify_cache = false;
+    string binary_output;
+    string serve_path;
+    unsigned workers = max(1u, thread::hardware_concurrency());
+    double time_limit = 0;
+    long long conflict_limit = -1;
+    string heuristic;
+    bool reorder = false;
+    string config_path;
+    bool print_config = false;
+    string selector_path;
+    double select_slice = 2.0;
+    bool print_features = false;
+    bool enumerate_models = false;
+    bool count_models = false;
+    vector<int> projection;
+    long long max_models = -1;
+    long long multiplex_conflicts = 0;
+    vector<string> inputs;
+    string trace_path;
+    string replay_path;
+    bool perf_counters = false;
+    bool core = false;
+    bool minimize_core_clauses = false;
+    bool usage_error = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool valid = true;
+        if (arg == "--snapshot" && i + 1 < argc)
+            snapshot_path = argv[++i];
+        else if (arg == "--snapshot-interval" && i + 1 < argc)
+            valid = parse_number(argv[++i], 0.0, snapshot_interval);
+        else if (arg == "--resume" && i + 1 < argc)
+            resume_path = argv[++i];
+        else if (arg == "--cache" && i + 1 < argc)
+            cache_dir = argv[++i];
+        else if (arg == "--verify-cache")
+            verify_cache = true;
+        else if (arg == "--write-binary" && i + 1 < argc)
+            binary_output = argv[++i];
+        else if (arg == "--serve" && i + 1 < argc)
+            serve_path = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc)
+            valid = parse_integer(argv[++i], 1u, 4096u, workers);
+        else if (arg == "--time-limit" && i + 1 < argc)
+            valid = parse_number(argv[++i], 0.0, time_limit);
+        else if (arg == "--conflict-limit" && i + 1 < argc)
+            valid = parse_integer(argv[++i], 0LL, LLONG_MAX, conflict_limit);
+        else if (arg == "--heuristic" && i + 1 < argc) {
+            heuristic = argv[++i];
+            if (heuristic != "lookahead" && heuristic != "vsids")
+                usage_error = true;
+        }
+        else if (arg == "--reorder")
+            reorder = true;
+        else if (arg == "--config" && i + 1 < argc)
+            config_path = argv[++i];
+        else if (arg == "--print-config")
+            print_config = true;
+        else if (arg == "--select" && i + 1 < argc)
+            selector_path = argv[++i];
+        else if (arg == "--select-slice" && i + 1 < argc)
+            valid = parse_number(argv[++i], 0.0, select_slice) && select_slice > 0;
+        else if (arg == "--print-features")
+            print_features = true;
+        else if (arg == "--all-models")
+            enumerate_models = true;
+        else if (arg == "--count")
+            count_models = true;
+        else if (arg == "--project" && i + 1 < argc) {
+            istringstream vars(argv[++i]);
+            string var;
+            int literal = 0;
+            while (valid && getline(vars, var, ',')) {
+                valid = parse_integer(var.c_str(), -INT_MAX, INT_MAX, literal) && literal != 0;
+                if (valid)
+                    projection.push_back(abs(literal));
+            }
+        }
+        else if (arg == "--max-models" && i + 1 < argc)
+            valid = parse_integer(argv[++i], 1LL, LLONG_MAX, max_models);
+        else if (arg == "--trace" && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (arg == "--perf-counters")
+            perf_counters = true;
+        else if (arg == "--multiplex" && i + 1 < argc)
+            valid = parse_integer(argv[++i], 1LL, LLONG_MAX, multiplex_conflicts);
+        else if (arg == "--core")
+            core = true;
+        else if (arg == "--minimize-core")
+            core = minimize_core_clauses = true;
+        else if (arg.rfind("--", 0) != 0)
+            inputs.push_back(arg);
+        else
+            usage_error = true;
+        if (!valid) {
+            cerr << "Error: Invalid value " << argv[i] << " for " << arg << ".\n";
+            return 1;
+        }
+    }
+    if (!inputs.empty())
+        file_path = inputs.front();
+    bool multiplex = (multiplex_conflicts > 0);
+    if (inputs.size() > 1 && !multiplex)
+        usage_error = true;
+    bool enumeration = enumerate_models || count_models;
+    if (multiplex && (enumeration || !cache_dir.empty() || !snapshot_path.empty() || !resume_path.empty() ||
+                      !selector_path.empty() || !binary_output.empty() || print_features))
+        usage_error = true;
+    if (enumeration && (!cache_dir.empty() || !snapshot_path.empty() || !resume_path.empty() || !selector_path.empty()))
+        usage_error = true;
+    if (core && (multiplex || enumeration || !cache_dir.empty() || !resume_path.empty() || !selector_path.empty()))
+        usage_error = true;
+    if ((!trace_path.empty() || !replay_path.empty()) &&
+        (multiplex || enumeration || !cache_dir.empty() || !snapshot_path.empty() || !resume_path.empty() ||
+         !selector_path.empty()))
+        usage_error = true;
+    if (print_config && !usage_error && file_path.empty() && serve_path.empty()) {
+        DPLLSolver_DS defaults;
+        try {
+            if (!config_path.empty())
+                load_solver_config(config_path, defaults);
+        } catch (const exception& e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+        print_solver_config(cout, defaults);
+        return 0;
+    }
+    if (usage_error || print_config || file_path.empty() == serve_path.empty()) {
+        cout << "Usage: ./DPLL_CDCL_VSIDS [--snapshot <file>] [--snapshot-interval <seconds>] [--resume <file>]\n"
+                "                         [--cache <dir> [--verify-cache]] [--write-binary <bcnf_file>]\n"
+                "                         [--time-limit <seconds>] [--conflict-limit <n>] [--heuristic vsids|lookahead]\n"
+                "                         [--reorder] [--config <file>] [--select <model> [--select-slice <seconds>]] [--print-features]\n"
+                "                         [--all-models | --count] [--project <v1,v2,...>] [--max-models <n>]\n"
+                "                         [--trace <file>] [--replay <file>] [--core | --minimize-core] [--workers <n>]\n"
+                "                         <cnf_file | bcnf_file>\n"
+                "       ./DPLL_CDCL_VSIDS --multiplex <step_conflicts> [--time-limit <seconds>] [--heuristic vsids|lookahead]\n"
+                "                         [--reorder] [--config <file>] <cnf_file | bcnf_file>...\n"
+                "       --perf-counters (builds with -DSAT_PROFILE): add hardware counters to the phase profile\n"
+                "       ./DPLL_CDCL_VSIDS --serve <socket> [--workers <n>]\n"
+                "       ./DPLL_CDCL_VSIDS --print-config [--config <file>]\n";
+        return 1;
+    }
+
+    if (perf_counters) {
+#ifdef SAT_PROFILE
+        perf_counters_requested = true;
+#else
+        cerr << "Error: --perf-counters needs a build with -DSAT_PROFILE.\n";
+        return 1;
+#endif
+    }
+
+    if (!serve_path.empty()) {
+#ifdef SAT_HAVE_UNIX_SOCKETS
+        try {
+            run_solver_daemon(serve_path, workers);
+        } catch (const exception& e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+#else
+        cerr << "Error: --serve needs Unix domain sockets, which this platform lacks.\n";
+        return 1;
+#endif
+    }
+
+    try
+    {
+        for (const string& input : inputs) {
+            bool binary_input = input.size() >= 5 && input.substr(input.size() - 5) == ".bcnf";
+            if ((!binary_input && (input.size() < 4 || input.substr(input.size() - 4) != ".cnf")) ||
+                !std::filesystem::exists(input))
+            {
+                cerr << "Error: Input file must be a valid .cnf or .bcnf file and must exist.\n";
+                return 1;
+            }
+        }
+        bool binary_input = file_path.size() >= 5 && file_path.substr(file_path.size() - 5) == ".bcnf";
+
+        if (multiplex) {
+            auto start_time = chrono::high_resolution_clock::now();
+            vector<unique_ptr<DPLLSolver_DS>> solvers;
+            for (const string& input : inputs) {
+                solvers.push_back(make_unique<DPLLSolver_DS>());
+                if (input.size() >= 5 && input.substr(input.size() - 5) == ".bcnf")
+                    BinaryCnf(input).load_into(*solvers.back());
+                else
+                    load_cnf_pipelined(input, *solvers.back());
+                if (!config_path.empty())
+                    load_solver_config(config_path, *solvers.back());
+                if (!heuristic.empty())
+                    solvers.back()->set_lookahead(heuristic == "lookahead");
+                if (reorder)
+                    solvers.back()->set_parameter("reorder", 1);
+            }
+            cout << "[DPLL + CDCL + VSIDS]\n";
+            solve_multiplexed(solvers, inputs, multiplex_conflicts, time_limit);
+            chrono::duration<double> time_taken = chrono::high_resolution_clock::now() - start_time;
+            double memory_used = get_memory_usage();
+            if (!memory_backing_summary().empty())
+                cout << memory_backing_summary() << "\n";
+            std::cout << std::fixed << std::setprecision(7);
+            cout << "Time taken: " << time_taken.count() << " seconds\n";
+            std::cout.unsetf(std::ios_base::floatfield);
+            cout << "Memory used: " << memory_used << " KB\n";
+#ifdef SAT_PROFILE
+            print_profile(cout);
+#endif
+#ifdef SAT_ALLOC_CHECK
+            long long dropped_learned = 0;
+            for (const auto& solver : solvers)
+                dropped_learned += solver->dropped_learned_clauses;
+            if (!print_allocations(cout, dropped_learned))
+                return 1;
+#endif
+            return 0;
+        }
+
+        if (!binary_output.empty()) {
+            vector<unordered_set<int>> clauses = (binary_input ? BinaryCnf(file_path).to_clauses() : load_cnf(file_path).to_clauses());
+            BinaryCnf::write(binary_output, clauses);
+            cout << "Wrote " << clauses.size() << " clauses to " << binary_output << "\n";
+            return 0;
+        }
+
+        DPLLSolver_DS solver;
+        solver.set_component_workers(workers);
+        if (core)
+            solver.track_core();
+        if (binary_input)
+            BinaryCnf(file_path).load_into(solver);
+        else
+            load_cnf_pipelined(file_path, solver);
+        if (!config_path.empty())
+            load_solver_config(config_path, solver);
+        if (!heuristic.empty())
+            solver.set_lookahead(heuristic == "lookahead");
+        if (reorder)
+            solver.set_parameter("reorder", 1);
+        if (print_features) {
+            for (const auto& feature : solver.instance_features())
+                cout << feature.first << " = " << feature.second << "\n";
+            return 0;
+        }
+
+        if (enumeration) {
+            // Stream models (unless only counting) while the search runs.
+            auto start_time = chrono::high_resolution_clock::now();
+            ModelCount count;
+            long long lines = 0;
+            solver.set_limits(conflict_limit, time_limit);
+            bool complete;
+            {
+                ModelWriter writer(stdout);
+                complete = solver.enumerate(projection, [&](const vector<int>& cube, int free_vars) {
+                    count.add_power_of_two(free_vars);
+                    if (enumerate_models)
+                        writer.write(cube);
+                    return max_models < 0 || ++lines < max_models;
+                });
+            }
+            chrono::duration<double> time_taken = chrono::high_resolution_clock::now() - start_time;
+            double memory_used = get_memory_usage();
+            cout << "[DPLL + CDCL + VSIDS]\nRESULT: "
+                 << (!count.is_zero() ? "SAT" : complete ? "UNSAT" : "UNKNOWN") << "\n";
+            cout << "MODELS: " << count.to_string() << (complete ? "" : " (incomplete)") << "\n";
+            if (!memory_backing_summary().empty())
+                cout << memory_backing_summary() << "\n";
+            std::cout << std::fixed << std::setprecision(7);
+            cout << "Time taken: " << time_taken.count() << " seconds\n";
+            std::cout.unsetf(std::ios_base::floatfield);
+            cout << "Memory used: " << memory_used << " KB\n";
+#ifdef SAT_PROFILE
+            print_profile(cout);
+#endif
+#ifdef SAT_ALLOC_CHECK
+            if (!print_allocations(cout, solver.dropped_learned_clauses))
+                return 1;
+#endif
+            return 0;
+        }
+
+        auto start_time = chrono::high_resolution_clock::now();
+        SolveStatus status = SolveStatus::Unknown;
+        bool cache_hit = false;
+        string engine;
+        vector<int> model;
+        vector<int> core_clauses;
+        int core_trials = 0;
+        FormulaKey key;
+        if (!cache_dir.empty()) {
+            // A cache hit replaces the solve; a cached model is optionally re-checked.
+            ResultCache cache(cache_dir);
+            key = solver.get_formula_key();
+            CachedResult entry;
+            if (cache.lookup(key, solver.get_formula_shape(), entry)) {
+                if (verify_cache && entry.satisfiable && !model_satisfies(solver.original_cnf, entry.model)) {
+                    cerr << "Warning: Cached model failed verification; solving again.\n";
+                    cache.erase(key);
+                } else {
+                    cache_hit = true;
+                    status = (entry.satisfiable ? SolveStatus::Satisfiable : SolveStatus::Unsatisfiable);
+                    model = entry.model;
+                }
+            }
+        }
+        if (!cache_hit) {
+            if (!resume_path.empty())
+                solver.load_snapshot(resume_path);
+            if (!snapshot_path.empty())
+                solver.enable_snapshots(snapshot_path, snapshot_interval);
+            if (!replay_path.empty())
+                solver.replay_trace(replay_path);
+            if (!trace_path.empty())
+                solver.record_trace(trace_path);
+            if (!selector_path.empty()) {
+                AlgorithmSelector selector(selector_path);
+                status = solve_scheduled(solver, selector, select_slice, conflict_limit, time_limit, engine);
+            } else {
+                solver.set_limits(conflict_limit, time_limit);
+                status = solver.solve_limited();
+            }
+            if (status == SolveStatus::Satisfiable)
+                model = solver.get_model();
+            if (core && status == SolveStatus::Unsatisfiable) {
+                core_clauses = (minimize_core_clauses ? minimize_core(solver, conflict_limit, core_trials) : solver.unsat_core());
+            }
+            if (!cache_dir.empty() && status != SolveStatus::Unknown) {
+                CachedResult entry;
+                entry.shape = solver.get_formula_shape();
+                entry.satisfiable = (status == SolveStatus::Satisfiable);
+                entry.model = model;
+                entry.conflicts = solver.conflicts;
+                entry.solve_seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start_time).count();
+                if (!ResultCache(cache_dir).store(key, entry))
+                    cerr << "Warning: Could not write result cache entry in " << cache_dir << ".\n";
+            }
+        }
+        auto end_time = chrono::high_resolution_clock::now();
+        chrono::duration<double> time_taken = end_time - start_time;
+        double memory_used = get_memory_usage();
+
+        cout << "[DPLL + CDCL + VSIDS]\nRESULT: "
+             << (status == SolveStatus::Satisfiable ? "SAT" : status == SolveStatus::Unsatisfiable ? "UNSAT" : "UNKNOWN") << "\n";
+        if (status == SolveStatus::Satisfiable) {
+            cout << "ASSIGNMENT: ";
+            for (int lit : model)
+                cout << abs(lit) << "=" << (lit > 0 ? 1 : 0) << " ";
+            cout << "\n";
+        }
+        if (core && status == SolveStatus::Unsatisfiable) {
+            // Input clauses numbered from 1 in file order.
+            cout << "CORE: ";
+            for (int id : core_clauses)
+                cout << id + 1 << " ";
+            cout << "\n";
+            cout << "Core: " << core_clauses.size() << " of " << solver.input_clause_count() << " clauses";
+            if (minimize_core_clauses)
+                cout << ", minimized in " << core_trials << " trials";
+            cout << "\n";
+        }
+        if (cache_hit)
+            cout << "Cache: hit " << key.hex() << "\n";
+        if (!engine.empty())
+            cout << "Engine: " << engine << "\n";
+        if (solver.components_solved > 1)
+            cout << "Components: " << solver.components_solved << "\n";
+        if (solver.dropped_learned_clauses > 0)
+            cout << "Learned clauses dropped: " << solver.dropped_learned_clauses << "\n";
+        if (!solver.trace_summary().empty())
+            cout << solver.trace_summary() << "\n";
+        if (!memory_backing_summary().empty())
+            cout << memory_backing_summary() << "\n";
+        std::cout << std::fixed << std::setprecision(7);
+        cout << "Time taken: " << time_taken.count() << " seconds\n";
+        // Reset formatting to default for memory output
+        std::cout.unsetf(std::ios_base::floatfield);
+        cout << "Memory used: " << memory_used << " KB\n";
+#ifdef SAT_PROFILE
+        print_profile(cout);
+#endif
+#ifdef SAT_ALLOC_CHECK
+        if (!print_allocations(cout, solver.dropped_learned_clauses))
+            return 1;
+#endif
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
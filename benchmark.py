@@ -1,21 +1,34 @@
+import argparse
 import subprocess
 import os
 import re
 import pandas as pd
- 
-# Binaries and their labels
+import satsolver
+from generate_cnf import generate, write_cnf
+
+# Solvers and their labels. DPLL_CDCL_VSIDS runs in-process through libsatsolver.so
+# (falling back to the executable if the library is missing); the two baseline
+# solvers only exist as executables.
 solvers = [
     ("./DPLL", "DPLL"),
     ("./DPLL_CDCL", "CDCL"),
     ("./DPLL_CDCL_VSIDS", "VSIDS")
 ]
- 
+in_process = {"VSIDS"}
+
 # Folder and list of CNF files to test
 benchmark_folder = "benchmark_files"
-cnf_files = [f for f in os.listdir(benchmark_folder) if f.endswith(".cnf")]
- 
-results = []
- 
+generated_folder = os.path.join(benchmark_folder, "generated")
+
+# Scaling sweep: instance sizes per generated family (variables for k-SAT, vertices
+# for flat graph colouring) and the seeds used at every size.
+sweep_sizes = {
+    "ksat": [50, 75, 100, 125, 150, 175, 200, 250],
+    "planted": [50, 100, 150, 200, 300, 400, 500],
+    "flat": [30, 50, 75, 100, 150, 200],
+}
+sweep_seeds = [1, 2, 3]
+
 def extract_vars_clauses(file_path):
     with open(file_path, 'r') as f:
         for line in f:
@@ -23,77 +36,209 @@ def extract_vars_clauses(file_path):
                 _, _, vars_str, clauses_str = line.strip().split()
                 return int(vars_str), int(clauses_str)
     return -1, -1  # Default if not found
- 
-# Run each solver on each CNF file
-for cnf_file in cnf_files:
-    cnf_path = os.path.join(benchmark_folder, cnf_file)
-    variables, clauses = extract_vars_clauses(cnf_path)
- 
-    row = {
-        "Benchmark": cnf_file,
-        "Variables": variables,
-        "Clauses": clauses,
-        "Result": ""
-    }
- 
-    for exe, label in solvers:
-        try:
+
+# Solve in-process with libsatsolver.so. Time is the solve alone, as the executables
+# report it; memory is the growth of this process's resident set during the solve.
+def run_library(cnf_path, timeout):
+    try:
+        result, stats = satsolver.solve_file(cnf_path, time_limit=timeout)
+    except Exception:
+        return "ERROR", "ERROR", "ERROR"
+    if result == "UNKNOWN":
+        return "TIMEOUT", "TIMEOUT", "TIMEOUT"
+    return result, round(stats["seconds"], 6), stats["memory_kb"]
+
+def library_available():
+    try:
+        satsolver.load_library()
+        return True
+    except OSError:
+        print(f"{satsolver.library_path()} not found; running DPLL_CDCL_VSIDS as a process.")
+        return False
+
+# Run one solver on one file; returns (result, seconds, KB) or the failure kind.
+def run_solver(exe, label, cnf_path, timeout):
+    if label in in_process:
+        return run_library(cnf_path, timeout)
+    try:
+        output = subprocess.check_output(
+            [exe, cnf_path],
+            stderr=subprocess.STDOUT,
+            text=True,
+            timeout=timeout
+        )
+    except subprocess.TimeoutExpired:
+        return "TIMEOUT", "TIMEOUT", "TIMEOUT"
+    except Exception:
+        return "ERROR", "ERROR", "ERROR"
+
+    result_match = re.search(r"RESULT:\s+(SAT|UNSAT)", output)
+    time_match = re.search(r"Time taken:\s+([\d.]+)", output)
+    memory_match = re.search(r"Memory used:\s+([\d.]+)", output)
+
+    result = result_match.group(1) if result_match else "N/A"
+    time = float(time_match.group(1)) if time_match else -1
+    memory_KB = memory_match.group(1) if memory_match else -1
+    return result, round(time, 6), memory_KB
+
+# Fixed SATLIB files: one row per file, one time/memory column pair per solver.
+def run_suite(timeout):
+    cnf_files = [f for f in os.listdir(benchmark_folder) if f.endswith(".cnf")]
+    results = []
+    for cnf_file in cnf_files:
+        cnf_path = os.path.join(benchmark_folder, cnf_file)
+        variables, clauses = extract_vars_clauses(cnf_path)
+
+        row = {
+            "Benchmark": cnf_file,
+            "Variables": variables,
+            "Clauses": clauses,
+            "Result": ""
+        }
+
+        for exe, label in solvers:
             print(f"Running {exe} on {cnf_file}")
-            output = subprocess.check_output(
-                [exe, cnf_path],
-                stderr=subprocess.STDOUT,
-                text=True,
-                timeout=700
-            )
- 
-            result_match = re.search(r"RESULT:\s+(SAT|UNSAT)", output)
-            time_match = re.search(r"Time taken:\s+([\d.]+)", output)
-            memory_match = re.search(r"Memory used:\s+([\d.]+)", output)
- 
-            result = result_match.group(1) if result_match else "N/A"
-            time = float(time_match.group(1)) if time_match else -1
-            memory_KB = memory_match.group(1) if memory_match else -1
- 
-            if label == "VSIDS":
+            result, time, memory_KB = run_solver(exe, label, cnf_path, timeout)
+            if label == "VSIDS" or result in ("TIMEOUT", "ERROR"):
                 row["Result"] = result
- 
-            row[f"Time ({label})"] = round(time, 6)
+            row[f"Time ({label})"] = time
             row[f"Memory ({label})"] = memory_KB
-            # row[f"Memory ({label})"] = round(memory_KB, 2)
- 
-        except subprocess.TimeoutExpired:
-            row[f"Time ({label})"] = "TIMEOUT"
-            row[f"Memory ({label})"] = "TIMEOUT"
-            row["Result"] = "TIMEOUT"
-        except Exception as e:
-            row[f"Time ({label})"] = f"ERROR"
-            row[f"Memory ({label})"] = f"ERROR"
-            row["Result"] = "ERROR"
- 
-    results.append(row)
- 
-# Display table
-df = pd.DataFrame(results)
-# Sort by number of variables and clauses
-df = df.sort_values(by=["Variables", "Clauses"])
- 
-# Rename columns for visual match with figure
-df = df.rename(columns={
-    "Time (DPLL)": "DPLL(s)",
-    "Time (CDCL)": "CDCL(s)",
-    "Time (VSIDS)": "VSIDS(s)",
-    "Memory (DPLL)": "DPLL(KB)",
-    "Memory (CDCL)": "CDCL(KB)",
-    "Memory (VSIDS)": "VSIDS(KB)"
-})
- 
-# Reorder columns
-df = df[["Benchmark", "Variables", "Clauses", "Result",
-         "DPLL(s)", "CDCL(s)", "VSIDS(s)",
-         "DPLL(KB)", "CDCL(KB)", "VSIDS(KB)"]]
- 
-# Print table
-print(df.to_string(index=False))
- 
-# Optional: save to CSV
-df.to_csv("solver_comparison_tabulated.csv", index=False)
\ No newline at end of file
+
+        results.append(row)
+
+    # Display table
+    df = pd.DataFrame(results)
+    # Sort by number of variables and clauses
+    df = df.sort_values(by=["Variables", "Clauses"])
+
+    # Rename columns for visual match with figure
+    df = df.rename(columns={
+        "Time (DPLL)": "DPLL(s)",
+        "Time (CDCL)": "CDCL(s)",
+        "Time (VSIDS)": "VSIDS(s)",
+        "Memory (DPLL)": "DPLL(KB)",
+        "Memory (CDCL)": "CDCL(KB)",
+        "Memory (VSIDS)": "VSIDS(KB)"
+    })
+
+    # Reorder columns
+    df = df[["Benchmark", "Variables", "Clauses", "Result",
+             "DPLL(s)", "CDCL(s)", "VSIDS(s)",
+             "DPLL(KB)", "CDCL(KB)", "VSIDS(KB)"]]
+
+    # Print table
+    print(df.to_string(index=False))
+    df.to_csv("solver_comparison_tabulated.csv", index=False)
+
+# Generated instances of growing size: one row per (instance, solver). A solver that
+# times out at some size of a family is not run on the larger sizes of that family.
+def run_scaling(timeout, families):
+    os.makedirs(generated_folder, exist_ok=True)
+    results = []
+    for family in families:
+        gave_up = set()
+        for size in sweep_sizes[family]:
+            for seed in sweep_seeds:
+                cnf_file = f"{family}-{size}-s{seed}.cnf"
+                cnf_path = os.path.join(generated_folder, cnf_file)
+                if not os.path.exists(cnf_path):
+                    num_vars, clauses = generate(family, size, seed)
+                    write_cnf(cnf_path, num_vars, clauses, f"{family} size={size} seed={seed}")
+                variables, clauses = extract_vars_clauses(cnf_path)
+                for exe, label in solvers:
+                    if label in gave_up:
+                        result, time, memory_KB = "SKIPPED", "SKIPPED", "SKIPPED"
+                    else:
+                        print(f"Running {exe} on {cnf_file}")
+                        result, time, memory_KB = run_solver(exe, label, cnf_path, timeout)
+                        if result == "TIMEOUT":
+                            gave_up.add(label)
+                    results.append({
+                        "Family": family,
+                        "Size": size,
+                        "Seed": seed,
+                        "Variables": variables,
+                        "Clauses": clauses,
+                        "Solver": label,
+                        "Result": result,
+                        "Time(s)": time,
+                        "Memory(KB)": memory_KB
+                    })
+
+    df = pd.DataFrame(results)
+    df.to_csv("scaling_results.csv", index=False)
+
+    # Growth curves: median time and memory per family, size and solver.
+    solved = df[pd.to_numeric(df["Time(s)"], errors="coerce").notna()].copy()
+    solved["Time(s)"] = solved["Time(s)"].astype(float)
+    solved["Memory(KB)"] = solved["Memory(KB)"].astype(float)
+    summary = solved.groupby(["Family", "Variables", "Solver"])[["Time(s)", "Memory(KB)"]].median()
+    print(summary.unstack("Solver").to_string())
+
+# Variable renumbering for locality (--reorder): each instance is solved in-process with
+# and without it. The profiling build, if present, adds the cache misses counted during
+# propagation. The two runs may take different search paths, since the decision
+# heuristics break ties by variable number; the conflict counts show by how much.
+def run_locality(timeout, profile_exe="./DPLL_CDCL_VSIDS_profile"):
+    os.makedirs(generated_folder, exist_ok=True)
+    paths = [os.path.join(benchmark_folder, f) for f in sorted(os.listdir(benchmark_folder)) if f.endswith(".cnf")]
+    for family, size in [("flat", 200), ("planted", 500)]:
+        path = os.path.join(generated_folder, f"{family}-{size}-s1.cnf")
+        if not os.path.exists(path):
+            num_vars, clauses = generate(family, size, 1)
+            write_cnf(path, num_vars, clauses, f"{family} size={size} seed=1")
+        paths.append(path)
+    results = []
+    for cnf_path in paths:
+        variables, clauses = extract_vars_clauses(cnf_path)
+        row = {"Benchmark": os.path.basename(cnf_path), "Variables": variables, "Clauses": clauses}
+        for label, reorder in (("input", 0), ("reorder", 1)):
+            print(f"Running VSIDS ({label} order) on {row['Benchmark']}")
+            try:
+                result, stats = satsolver.solve_file(cnf_path, time_limit=timeout, parameters={"reorder": reorder})
+                row[f"{label}(s)"] = round(stats["seconds"], 6) if result != "UNKNOWN" else "TIMEOUT"
+                row[f"{label} conflicts"] = int(stats["conflicts"])
+            except Exception:
+                row[f"{label}(s)"] = "ERROR"
+            if os.path.exists(profile_exe):
+                row[f"{label} cache-misses"] = propagate_cache_misses(profile_exe, cnf_path, reorder, timeout)
+        results.append(row)
+    df = pd.DataFrame(results)
+    print(df.to_string(index=False))
+    df.to_csv("locality_results.csv", index=False)
+
+# Cache misses of the propagate phase from a profiling build's --perf-counters table
+# ("N/A" without hardware counters).
+def propagate_cache_misses(profile_exe, cnf_path, reorder, timeout):
+    command = [profile_exe, "--perf-counters", "--time-limit", str(timeout)] + (["--reorder"] if reorder else []) + [cnf_path]
+    try:
+        output = subprocess.check_output(command, stderr=subprocess.STDOUT, text=True, timeout=timeout + 10)
+    except Exception:
+        return "ERROR"
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 9 and fields[0] == "propagate":
+            return int(fields[7])
+    return "N/A"
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmark the three solvers.")
+    parser.add_argument("--suite", action="store_true",
+                        help="run the fixed files in benchmark_files instead of the scaling sweep")
+    parser.add_argument("--locality", action="store_true",
+                        help="compare solving with and without variable renumbering (needs libsatsolver.so)")
+    parser.add_argument("--families", default="ksat,planted,flat",
+                        help="comma-separated generated families for the sweep")
+    parser.add_argument("--timeout", type=float, default=None,
+                        help="seconds per run (default 700 for --suite, 60 for the sweep)")
+    parser.add_argument("--subprocess", action="store_true",
+                        help="run DPLL_CDCL_VSIDS as an executable instead of through libsatsolver.so")
+    args = parser.parse_args()
+    if args.subprocess or not library_available():
+        in_process.clear()
+    if args.locality:
+        run_locality(args.timeout or 60)
+    elif args.suite:
+        run_suite(args.timeout or 700)
+    else:
+        run_scaling(args.timeout or 60, args.families.split(","))
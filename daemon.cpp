@@ -0,0 +1,405 @@
+// DPLL + CDCL + VSIDS: the --serve daemon (see daemon.h)
+
+#include "daemon.h"
+
+#ifdef SAT_HAVE_UNIX_SOCKETS
+#include "solver.h"
+#include "formats.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+// Long-lived solver service on a Unix domain socket, so a query no longer pays for process
+// startup. Requests are text lines; a SOLVE line is followed by exactly <bytes> of payload:
+//   SOLVE <id> <dimacs|binary> <bytes> [time=<seconds>] [conflicts=<n>]
+//   CANCEL <id>
+//   STATS
+// Replies are tagged with the job id, and a connection may have several jobs in flight:
+//   ACCEPTED <id>
+//   RESULT <id> SAT|UNSAT|UNKNOWN conflicts=<n> restarts=<n> queued=<s> seconds=<s>
+//   MODEL <id> <literals> 0                      (follows a SAT result)
+//   ERROR <id> <message>
+//   STATS workers=<n> queued=<n> running=<n> completed=<n>
+// Closing the connection cancels its outstanding jobs.
+class SolverDaemon {
+public:
+    SolverDaemon(const string& socket_path, unsigned workers)
+        : path(socket_path), worker_count(max(1u, workers)), listen_fd(-1),
+          stopping(false), running(0), completed(0) {}
+
+    ~SolverDaemon() {
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            unlink(path.c_str());
+        }
+    }
+
+    // Accept connections until the listening socket fails; each connection gets a
+    // reader thread, up to MAX_CONNECTIONS at once, and all jobs share one pool of
+    // worker threads.
+    void serve() {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw runtime_error("Error: Socket path " + path + " is too long.");
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0)
+            throw runtime_error("Error: Could not create a Unix domain socket.");
+        unlink(path.c_str());
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd, 64) != 0)
+            throw runtime_error("Error: Could not listen on " + path + ".");
+        cout << "Listening on " << path << " with " << worker_count << " workers" << endl;
+
+        vector<thread> pool;
+        for (unsigned i = 0; i < worker_count; i++) {
+            pool.emplace_back([this, i] {
+                bind_worker_to_numa_node(i);
+                work();
+            });
+        }
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                break;
+            }
+            join_finished_readers();
+            auto connection = make_shared<Connection>(fd);
+            if (readers.size() >= MAX_CONNECTIONS) {
+                connection->send("ERROR - too many connections\n");
+                continue;
+            }
+            auto finished = make_shared<atomic<bool>>(false);
+            thread reader([this, connection, finished] {
+                read_requests(connection);
+                *finished = true;
+            });
+            readers.push_back({move(reader), connection, finished});
+        }
+        // Wake the readers still waiting on their clients; that also cancels their jobs.
+        for (auto& reader : readers) {
+            if (auto connection = reader.connection.lock())
+                shutdown(connection->fd, SHUT_RDWR);
+        }
+        for (auto& reader : readers)
+            reader.worker.join();
+        readers.clear();
+        {
+            lock_guard<mutex> lock(queue_lock);
+            stopping = true;
+        }
+        queue_ready.notify_all();
+        for (auto& t : pool)
+            t.join();
+    }
+
+private:
+    static constexpr size_t MAX_PAYLOAD = size_t(1) << 30;
+    static constexpr size_t MAX_CONNECTIONS = 128;
+
+    struct Job;
+
+    // One client. Replies from the reader and the workers are serialised by write_lock;
+    // the socket closes when the reader and every job holding the connection are done.
+    struct Connection {
+        int fd;
+        mutex write_lock;
+        mutex jobs_lock;
+        unordered_map<string, shared_ptr<Job>> jobs;    // Accepted and not yet answered
+
+        explicit Connection(int descriptor) : fd(descriptor) {}
+        ~Connection() { close(fd); }
+
+        void send(const string& message) {
+            lock_guard<mutex> lock(write_lock);
+            size_t sent = 0;
+            while (sent < message.size()) {
+                ssize_t n = ::send(fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return;     // The client went away; its jobs are cancelled by the reader.
+                sent += n;
+            }
+        }
+    };
+
+    // The thread reading one connection's requests. It owns no reference to the
+    // connection, so the socket still closes as soon as the reader and its jobs are done.
+    struct ReaderThread {
+        thread worker;
+        weak_ptr<Connection> connection;
+        shared_ptr<atomic<bool>> finished;
+    };
+
+    struct Job {
+        string id;
+        bool binary;
+        vector<char> payload;
+        double time_limit;
+        long long conflict_limit;
+        atomic<bool> cancel;
+        chrono::steady_clock::time_point accepted;
+        shared_ptr<Connection> connection;
+        Job() : binary(false), time_limit(0), conflict_limit(-1), cancel(false) {}
+    };
+
+    string path;
+    unsigned worker_count;
+    int listen_fd;
+    mutex queue_lock;
+    condition_variable queue_ready;
+    deque<shared_ptr<Job>> queue;
+    bool stopping;
+    atomic<int> running;
+    atomic<long long> completed;
+    vector<ReaderThread> readers;       // Used by the accepting thread only
+
+    // Join the reader threads whose clients have gone.
+    void join_finished_readers() {
+        auto done = stable_partition(readers.begin(), readers.end(), [](const ReaderThread& reader) { return !*reader.finished; });
+        for (auto it = done; it != readers.end(); ++it)
+            it->worker.join();
+        readers.erase(done, readers.end());
+    }
+
+    // Buffered reads of request lines and payloads from one connection.
+    class Reader {
+    public:
+        explicit Reader(int descriptor) : fd(descriptor), pos(0) {}
+
+        bool read_line(string& line) {
+            line.clear();
+            while (true) {
+                size_t nl = buffer.find('\n', pos);
+                if (nl != string::npos) {
+                    line.assign(buffer, pos, nl - pos);
+                    pos = nl + 1;
+                    if (!line.empty() && line.back() == '\r')
+                        line.pop_back();
+                    return true;
+                }
+                if (buffer.size() - pos > 4096 || !fill())
+                    return false;
+            }
+        }
+
+        bool read_bytes(vector<char>& out, size_t count) {
+            out.resize(count);
+            size_t have = 0;
+            while (have < count) {
+                if (pos == buffer.size() && !fill())
+                    return false;
+                size_t take = min(count - have, buffer.size() - pos);
+                memcpy(out.data() + have, buffer.data() + pos, take);
+                pos += take;
+                have += take;
+            }
+            return true;
+        }
+
+    private:
+        int fd;
+        string buffer;
+        size_t pos;
+
+        bool fill() {
+            buffer.erase(0, pos);
+            pos = 0;
+            char block[65536];
+            while (true) {
+                ssize_t n = recv(fd, block, sizeof(block), 0);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                buffer.append(block, n);
+                return true;
+            }
+        }
+    };
+
+    // A non-negative, finite number of seconds, spelled out in full.
+    static bool parse_seconds(const string& text, double& value) {
+        char* end = nullptr;
+        errno = 0;
+        double parsed = strtod(text.c_str(), &end);
+        if (text.empty() || *end != '\0' || errno == ERANGE || !isfinite(parsed) || parsed < 0)
+            return false;
+        value = parsed;
+        return true;
+    }
+
+    // A non-negative decimal count, spelled out in full.
+    static bool parse_count(const string& text, long long& value) {
+        char* end = nullptr;
+        errno = 0;
+        long long parsed = strtoll(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || errno == ERANGE || parsed < 0)
+            return false;
+        value = parsed;
+        return true;
+    }
+
+    void read_requests(shared_ptr<Connection> connection) {
+        Reader reader(connection->fd);
+        string line;
+        while (reader.read_line(line)) {
+            istringstream request(line);
+            string command, id;
+            request >> command >> id;
+            if (command == "SOLVE") {
+                string format;
+                size_t bytes = 0;
+                request >> format >> bytes;
+                if (id.empty() || (format != "dimacs" && format != "binary") || !request || bytes > MAX_PAYLOAD) {
+                    // The payload length is unknown or too large, so the stream cannot be resynchronised.
+                    connection->send("ERROR " + (id.empty() ? string("-") : id) + " malformed SOLVE request\n");
+                    break;
+                }
+                auto job = make_shared<Job>();
+                job->id = id;
+                job->binary = (format == "binary");
+                string option, option_error;
+                while (request >> option && option_error.empty()) {
+                    if (option.rfind("time=", 0) == 0) {
+                        if (!parse_seconds(option.substr(5), job->time_limit))
+                            option_error = "invalid SOLVE option " + option;
+                    } else if (option.rfind("conflicts=", 0) == 0) {
+                        if (!parse_count(option.substr(10), job->conflict_limit))
+                            option_error = "invalid SOLVE option " + option;
+                    } else {
+                        option_error = "unknown SOLVE option";
+                    }
+                }
+                if (!reader.read_bytes(job->payload, bytes))
+                    break;
+                if (!option_error.empty()) {
+                    connection->send("ERROR " + id + " " + option_error + "\n");
+                    continue;
+                }
+                {
+                    lock_guard<mutex> lock(connection->jobs_lock);
+                    if (!connection->jobs.emplace(id, job).second) {
+                        connection->send("ERROR " + id + " job id already in use\n");
+                        continue;
+                    }
+                }
+                job->connection = connection;
+                job->accepted = chrono::steady_clock::now();
+                connection->send("ACCEPTED " + id + "\n");
+                {
+                    lock_guard<mutex> lock(queue_lock);
+                    queue.push_back(job);
+                }
+                queue_ready.notify_one();
+            } else if (command == "CANCEL" && !id.empty()) {
+                lock_guard<mutex> lock(connection->jobs_lock);
+                auto it = connection->jobs.find(id);
+                if (it != connection->jobs.end())
+                    it->second->cancel = true;
+                else
+                    connection->send("ERROR " + id + " no such job\n");
+            } else if (command == "STATS") {
+                size_t queued;
+                {
+                    lock_guard<mutex> lock(queue_lock);
+                    queued = queue.size();
+                }
+                connection->send("STATS workers=" + to_string(worker_count) + " queued=" + to_string(queued) +
+                                 " running=" + to_string(running.load()) + " completed=" + to_string(completed.load()) + "\n");
+            } else {
+                connection->send("ERROR " + (id.empty() ? string("-") : id) + " unknown request\n");
+            }
+        }
+        // The client is gone or out of sync: stop its jobs. Their replies are dropped.
+        lock_guard<mutex> lock(connection->jobs_lock);
+        for (auto& entry : connection->jobs)
+            entry.second->cancel = true;
+    }
+
+    void work() {
+        while (true) {
+            shared_ptr<Job> job;
+            {
+                unique_lock<mutex> lock(queue_lock);
+                queue_ready.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                job = queue.front();
+                queue.pop_front();
+            }
+            running++;
+            run_job(*job);
+            running--;
+            completed++;
+            lock_guard<mutex> lock(job->connection->jobs_lock);
+            job->connection->jobs.erase(job->id);
+        }
+    }
+
+    // Solve one job on this worker thread. Parsing is single-threaded here, and the
+    // solver does not split the formula into components on threads of its own, because
+    // the pool already runs one job per core.
+    void run_job(Job& job) {
+        auto start = chrono::steady_clock::now();
+        double queued = chrono::duration<double>(start - job.accepted).count();
+        try {
+            DPLLSolver_DS solver;
+            solver.set_parameter("decompose", 0);
+            if (job.binary) {
+                BinaryCnf(job.payload.data(), job.payload.size()).load_into(solver);
+            } else {
+                ChunkedDimacsParser parser(job.payload.data(), job.payload.size(), 1);
+                load_cnf_pipelined(parser, solver);
+            }
+            vector<char>().swap(job.payload);
+            solver.set_limits(job.conflict_limit, job.time_limit, &job.cancel);
+            SolveStatus status = (job.cancel ? SolveStatus::Unknown : solver.solve_limited());
+            ostringstream reply;
+            reply << "RESULT " << job.id << " "
+                  << (status == SolveStatus::Satisfiable ? "SAT" : status == SolveStatus::Unsatisfiable ? "UNSAT" : "UNKNOWN")
+                  << " conflicts=" << solver.conflicts << " restarts=" << solver.restarts
+                  << fixed << setprecision(6) << " queued=" << queued
+                  << " seconds=" << chrono::duration<double>(chrono::steady_clock::now() - start).count() << "\n";
+            if (status == SolveStatus::Satisfiable) {
+                reply << "MODEL " << job.id;
+                for (int lit : solver.get_model())
+                    reply << " " << lit;
+                reply << " 0\n";
+            }
+            job.connection->send(reply.str());
+        } catch (const exception& e) {
+            string message = e.what();
+            replace(message.begin(), message.end(), '\n', ' ');
+            job.connection->send("ERROR " + job.id + " " + message + "\n");
+        }
+    }
+};
+
+void run_solver_daemon(const string& socket_path, unsigned workers) {
+    SolverDaemon(socket_path, workers).serve();
+}
+#endif
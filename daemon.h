@@ -0,0 +1,22 @@
+// DPLL + CDCL + VSIDS: the --serve daemon
+//
+// A long-lived solver service on a Unix domain socket; the protocol is described at
+// SolverDaemon in daemon.cpp. Only built where Unix domain sockets exist.
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+
+#ifdef __linux__
+#define SAT_HAVE_UNIX_SOCKETS 1
+#endif
+
+#ifdef SAT_HAVE_UNIX_SOCKETS
+// Listen on socket_path and solve the requests of its clients on a pool of worker
+// threads, until the listening socket fails. Throws runtime_error if the socket cannot
+// be set up.
+void run_solver_daemon(const std::string& socket_path, unsigned workers);
+#endif
+
+#endif
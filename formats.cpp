@@ -0,0 +1,245 @@
+// DPLL + CDCL + VSIDS: file formats of the command line (see formats.h)
+
+#include "formats.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+bool ResultCache::lookup(const FormulaKey& key, const FormulaShape& shape, CachedResult& entry) const {
+    ifstream in(entry_path(key));
+    string tag, result;
+    if (!(in >> tag >> result) || tag != "SATCACHE2")
+        return false;
+    entry.satisfiable = (result == "SAT");
+    if (!entry.satisfiable && result != "UNSAT")
+        return false;
+    if (!(in >> entry.shape.clauses >> entry.shape.variables) || !(entry.shape == shape))
+        return false;
+    size_t model_size = 0;
+    if (!(in >> entry.conflicts >> entry.solve_seconds >> model_size))
+        return false;
+    entry.model.resize(model_size);
+    for (size_t i = 0; i < model_size; i++) {
+        if (!(in >> entry.model[i]))
+            return false;
+    }
+    return true;
+}
+
+bool ResultCache::store(const FormulaKey& key, const CachedResult& entry) const {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    string path = entry_path(key);
+    string tmp_path = path + ".tmp" + to_string(chrono::steady_clock::now().time_since_epoch().count());
+    {
+        ofstream out(tmp_path, ios::trunc);
+        if (!out)
+            return false;
+        out << "SATCACHE2 " << (entry.satisfiable ? "SAT" : "UNSAT") << "\n"
+            << entry.shape.clauses << " " << entry.shape.variables << "\n"
+            << entry.conflicts << " " << setprecision(9) << entry.solve_seconds << "\n"
+            << entry.model.size() << "\n";
+        for (int lit : entry.model)
+            out << lit << " ";
+        out << "\n";
+        if (!out)
+            return false;
+    }
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+void ResultCache::erase(const FormulaKey& key) const {
+    std::error_code ec;
+    std::filesystem::remove(entry_path(key), ec);
+}
+
+string ResultCache::entry_path(const FormulaKey& key) const {
+    return directory + "/" + key.hex() + ".result";
+}
+
+void ModelCount::add_power_of_two(int exponent) {
+    size_t word = exponent / 32;
+    if (words.size() <= word)
+        words.resize(word + 1, 0);
+    uint64_t carry = uint64_t(1) << (exponent % 32);
+    for (size_t i = word; carry != 0; i++) {
+        if (i == words.size())
+            words.push_back(0);
+        uint64_t sum = words[i] + carry;
+        words[i] = (uint32_t)sum;
+        carry = sum >> 32;
+    }
+}
+
+bool ModelCount::is_zero() const {
+    return all_of(words.begin(), words.end(), [](uint32_t w) { return w == 0; });
+}
+
+string ModelCount::to_string() const {
+    vector<uint32_t> n = words;
+    string digits;
+    while (any_of(n.begin(), n.end(), [](uint32_t w) { return w != 0; })) {
+        uint64_t rest = 0;
+        for (size_t i = n.size(); i-- > 0;) {
+            uint64_t cur = (rest << 32) | n[i];
+            n[i] = (uint32_t)(cur / 1000000000);
+            rest = cur % 1000000000;
+        }
+        string chunk = std::to_string(rest);
+        digits = chunk + digits;
+        if (any_of(n.begin(), n.end(), [](uint32_t w) { return w != 0; }))
+            digits = string(9 - chunk.size(), '0') + digits;
+    }
+    return digits.empty() ? "0" : digits;
+}
+
+ModelWriter::ModelWriter(FILE* out, size_t capacity) : out(out), capacity(capacity) {
+    buffer.reserve(capacity + 64);
+}
+
+void ModelWriter::write(const vector<int>& literals) {
+    buffer += 'v';
+    for (int lit : literals) {
+        if (buffer.size() > capacity)
+            flush();
+        char digits[16];
+        int n = 0;
+        unsigned value = (unsigned)abs(lit);
+        do {
+            digits[n++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        buffer += ' ';
+        if (lit < 0)
+            buffer += '-';
+        while (n > 0)
+            buffer += digits[--n];
+    }
+    buffer += " 0\n";
+    if (buffer.size() > capacity)
+        flush();
+}
+
+void ModelWriter::flush() {
+    if (!buffer.empty())
+        fwrite(buffer.data(), 1, buffer.size(), out);
+    buffer.clear();
+    fflush(out);
+}
+
+BinaryCnf::BinaryCnf(const string& path)
+    : file(new MappedFile(path)), data(file->data()), size(file->size())
+{
+    file->advise_sequential();
+    parse_header(path);
+}
+
+BinaryCnf::BinaryCnf(const char* bytes, size_t length)
+    : data(bytes), size(length)
+{
+    parse_header("payload");
+}
+
+vector<unordered_set<int>> BinaryCnf::to_clauses() const {
+    vector<unordered_set<int>> result(num_clauses);
+    for (uint64_t i = 0; i < num_clauses; i++) {
+        check_clause(i);
+        result[i].insert(clause_begin(i), clause_end(i));
+    }
+    if (result.empty())
+        throw runtime_error("Error: No valid clauses found in CNF file.");
+    return result;
+}
+
+void BinaryCnf::load_into(DPLLSolver_DS& solver) const {
+    SAT_PHASE(Parse);
+    if (num_clauses == 0)
+        throw runtime_error("Error: No valid clauses found in CNF file.");
+    for (uint64_t i = 0; i < num_clauses; i++) {
+        check_clause(i);
+        solver.add_clause(clause_begin(i), clause_end(i));
+    }
+    solver.declare_variables((long long)num_vars);
+    if (has_key())
+        solver.set_formula_key(key, shape);
+    solver.finish_loading();
+}
+
+void BinaryCnf::write(const string& path, const vector<unordered_set<int>>& clauses) {
+    uint64_t num_vars = 0, num_literals = 0;
+    for (const auto& clause : clauses) {
+        num_literals += clause.size();
+        for (int lit : clause)
+            num_vars = max<uint64_t>(num_vars, (uint64_t)abs(lit));
+    }
+    FormulaShape shape;
+    FormulaKey key = canonical_formula_key(clauses, SIZE_MAX, &shape);
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out)
+        throw runtime_error("Error: Cannot write binary CNF file " + path + ".");
+    char header[HEADER_SIZE] = {};
+    memcpy(header, MAGIC, 8);
+    uint32_t version = VERSION, flags = FLAG_HAS_KEY | FLAG_HAS_SHAPE;
+    uint32_t key_clauses = (uint32_t)shape.clauses, key_variables = (uint32_t)shape.variables;
+    uint64_t num_clauses = clauses.size();
+    memcpy(header + 8, &version, 4);
+    memcpy(header + 12, &flags, 4);
+    memcpy(header + 16, &num_vars, 8);
+    memcpy(header + 24, &num_clauses, 8);
+    memcpy(header + 32, &num_literals, 8);
+    memcpy(header + 40, &key.hi, 8);
+    memcpy(header + 48, &key.lo, 8);
+    memcpy(header + 56, &key_clauses, 4);
+    memcpy(header + 60, &key_variables, 4);
+    out.write(header, HEADER_SIZE);
+    uint64_t offset = 0;
+    out.write(reinterpret_cast<const char*>(&offset), 8);
+    for (const auto& clause : clauses) {
+        offset += clause.size();
+        out.write(reinterpret_cast<const char*>(&offset), 8);
+    }
+    for (const auto& clause : clauses) {
+        vector<int32_t> lits(clause.begin(), clause.end());
+        sort(lits.begin(), lits.end(), [](int32_t a, int32_t b) { return abs(a) < abs(b); });
+        out.write(reinterpret_cast<const char*>(lits.data()), 4 * lits.size());
+    }
+    if (!out)
+        throw runtime_error("Error: Failed writing binary CNF file " + path + ".");
+}
+
+void BinaryCnf::parse_header(const string& path) {
+    if (size < HEADER_SIZE || memcmp(data, MAGIC, 8) != 0)
+        throw runtime_error("Error: " + path + " is not a binary CNF file.");
+    uint32_t version = header_field<uint32_t>(8);
+    flags = header_field<uint32_t>(12);
+    num_vars = header_field<uint64_t>(16);
+    num_clauses = header_field<uint64_t>(24);
+    num_literals = header_field<uint64_t>(32);
+    key.hi = header_field<uint64_t>(40);
+    key.lo = header_field<uint64_t>(48);
+    shape.clauses = header_field<uint32_t>(56);
+    shape.variables = header_field<uint32_t>(60);
+    uint64_t expected = HEADER_SIZE + 8 * (num_clauses + 1) + 4 * num_literals;
+    if (version != VERSION || num_clauses > size || num_literals > size || expected != size)
+        throw runtime_error("Error: Binary CNF file " + path + " is truncated or has an unsupported version.");
+    offsets = reinterpret_cast<const uint64_t*>(data + HEADER_SIZE);
+    literals = reinterpret_cast<const int32_t*>(data + HEADER_SIZE + 8 * (num_clauses + 1));
+    if (offsets[0] != 0 || offsets[num_clauses] != num_literals)
+        throw runtime_error("Error: Binary CNF file " + path + " has a corrupt clause index.");
+}
+
+void BinaryCnf::check_clause(uint64_t i) const {
+    if (offsets[i + 1] < offsets[i] || offsets[i + 1] > num_literals)
+        throw runtime_error("Error: Binary CNF file has a corrupt clause index.");
+    for (const int32_t* lit = clause_begin(i); lit != clause_end(i); ++lit) {
+        if (*lit == 0 || (uint64_t)abs(*lit) > num_vars)
+            throw runtime_error("Error: Binary CNF file has a literal out of range.");
+    }
+}
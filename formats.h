@@ -0,0 +1,173 @@
+// DPLL + CDCL + VSIDS: file formats of the command line
+//
+// The result cache, model output and model counting, and the binary CNF container. The
+// definitions are in formats.cpp.
+
+#ifndef FORMATS_H
+#define FORMATS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "solver.h"
+
+// Result of an earlier solve, as stored in the result cache.
+struct CachedResult {
+    FormulaShape shape;         // Of the formula the result was computed for
+    bool satisfiable;
+    std::vector<int> model;     // Literals in variable order
+    long long conflicts;
+    double solve_seconds;
+    CachedResult() : satisfiable(false), conflicts(0), solve_seconds(0.0) {}
+};
+
+// On-disk cache of solve results keyed by canonical_formula_key(), one small text file
+// per formula: <dir>/<key>.result. An entry also records the normalised clause and
+// variable counts, and a lookup only hits if they match too, so that an UNSAT answer,
+// which cannot be checked, does not rest on the hash alone.
+class ResultCache {
+public:
+    explicit ResultCache(const std::string& dir) : directory(dir) {}
+
+    bool lookup(const FormulaKey& key, const FormulaShape& shape, CachedResult& entry) const;
+
+    // Write the entry to a temporary file and rename it into place, so that concurrent
+    // readers never see a partial entry.
+    bool store(const FormulaKey& key, const CachedResult& entry) const;
+
+    // Remove an entry that failed verification.
+    void erase(const FormulaKey& key) const;
+
+private:
+    std::string directory;
+
+    std::string entry_path(const FormulaKey& key) const;
+};
+
+// Check a model against the clauses in one linear pass.
+template <typename Clauses>
+bool model_satisfies(const Clauses& clauses, const std::vector<int>& model) {
+    int max_var = 0;
+    for (int lit : model)
+        max_var = std::max(max_var, std::abs(lit));
+    std::vector<int8_t> value(max_var + 1, -1);
+    for (int lit : model)
+        value[std::abs(lit)] = (lit > 0 ? 1 : 0);
+    for (size_t i = 0; i < clauses.size(); i++) {
+        bool satisfied = false;
+        for (int lit : clauses[i]) {
+            if (std::abs(lit) <= max_var && value[std::abs(lit)] == (lit > 0 ? 1 : 0)) {
+                satisfied = true;
+                break;
+            }
+        }
+        if (!satisfied)
+            return false;
+    }
+    return true;
+}
+
+// Exact model count, kept as a binary big integer: every enumerated cube adds 2^free.
+class ModelCount {
+public:
+    void add_power_of_two(int exponent);
+
+    bool is_zero() const;
+
+    std::string to_string() const;
+
+private:
+    std::vector<uint32_t> words;     // Little-endian base 2^32
+};
+
+// Streams models as DIMACS-style "v <literals> 0" lines. Integers are formatted by hand
+// into a large buffer that is written out in blocks, since enumeration can produce
+// millions of lines.
+class ModelWriter {
+public:
+    explicit ModelWriter(FILE* out, size_t capacity = 1 << 20);
+
+    ~ModelWriter() { flush(); }
+
+    void write(const std::vector<int>& literals);
+
+    void flush();
+
+private:
+    FILE* out;
+    size_t capacity;
+    std::string buffer;
+};
+
+// Binary CNF container ("SATBCNF1"), little-endian:
+//   64-byte header: magic[8], u32 version, u32 flags, u64 variables, u64 clauses,
+//                   u64 literals, u64 key_hi, u64 key_lo, u32 key_clauses, u32 key_variables
+//   u64 offsets[clauses + 1]   clause i is literals[offsets[i], offsets[i + 1])
+//   i32 literals[literals]
+// Bit 0 of flags marks key_hi/key_lo as a valid canonical_formula_key(), bit 1 marks
+// key_clauses/key_variables as its FormulaShape.
+// The file is memory-mapped, so loading costs page faults rather than integer parsing.
+// The solver still copies each clause into its own store, as add_clause() normalises it.
+class BinaryCnf {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_HAS_KEY = 1;
+    static constexpr uint32_t FLAG_HAS_SHAPE = 2;
+
+    explicit BinaryCnf(const std::string& path);
+
+    // View a binary CNF image already in memory; the bytes must outlive this object.
+    BinaryCnf(const char* bytes, size_t length);
+
+    uint64_t variables() const { return num_vars; }
+    uint64_t clauses() const { return num_clauses; }
+    // Files from before the shape was stored carry only the key; it is recomputed for them.
+    bool has_key() const { return (flags & (FLAG_HAS_KEY | FLAG_HAS_SHAPE)) == (FLAG_HAS_KEY | FLAG_HAS_SHAPE); }
+    const FormulaKey& formula_key() const { return key; }
+    const int32_t* clause_begin(uint64_t i) const { return literals + offsets[i]; }
+    const int32_t* clause_end(uint64_t i) const { return literals + offsets[i + 1]; }
+
+    // Build clause sets straight from the mapped literal array.
+    std::vector<std::unordered_set<int>> to_clauses() const;
+
+    // Feed the mapped clauses to the solver without an intermediate copy; add_clause()
+    // copies each one into the clause arena.
+    void load_into(DPLLSolver_DS& solver) const;
+
+    // Write clauses as a binary CNF file, including their canonical key.
+    static void write(const std::string& path, const std::vector<std::unordered_set<int>>& clauses);
+
+private:
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr const char* MAGIC = "SATBCNF1";
+
+    std::unique_ptr<MappedFile> file;    // Null for in-memory images
+    const char* data;
+    size_t size;
+    uint32_t flags;
+    uint64_t num_vars;
+    uint64_t num_clauses;
+    uint64_t num_literals;
+    FormulaKey key;
+    FormulaShape shape;
+    const uint64_t* offsets;
+    const int32_t* literals;
+
+    void parse_header(const std::string& path);
+
+    void check_clause(uint64_t i) const;
+
+    template <typename T>
+    T header_field(size_t offset) const {
+        T value;
+        memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+};
+
+#endif
@@ -0,0 +1,92 @@
+import argparse
+import random
+
+# Instance generators for the scaling study. Every generator takes an explicit seed,
+# so the same arguments always produce the same file.
+
+
+def random_ksat(num_vars, ratio, k=3, seed=0):
+    # Uniform random k-SAT: round(ratio * n) clauses, each over k distinct variables
+    # with random signs. Near ratio 4.26 (k = 3) about half of the instances are SAT.
+    rng = random.Random(seed)
+    clauses = []
+    for _ in range(round(ratio * num_vars)):
+        variables = rng.sample(range(1, num_vars + 1), k)
+        clauses.append([v if rng.random() < 0.5 else -v for v in variables])
+    return num_vars, clauses
+
+
+def planted_ksat(num_vars, ratio, k=3, seed=0):
+    # Random k-SAT with a hidden solution: clauses falsified by the planted assignment
+    # are rejected, so every instance is satisfiable.
+    rng = random.Random(seed)
+    planted = [None] + [rng.random() < 0.5 for _ in range(num_vars)]
+    clauses = []
+    while len(clauses) < round(ratio * num_vars):
+        variables = rng.sample(range(1, num_vars + 1), k)
+        clause = [v if rng.random() < 0.5 else -v for v in variables]
+        if any((lit > 0) == planted[abs(lit)] for lit in clause):
+            clauses.append(clause)
+    return num_vars, clauses
+
+
+def flat_coloring(num_vertices, num_edges, colors=3, seed=0):
+    # Flat graph colouring in the style of SATLIB's flat30 family: the vertices are split
+    # into colour classes of equal size and edges only join different classes, so the
+    # graph is colourable by construction. Variable (v, c) is v * colors + c + 1; each
+    # vertex gets exactly one colour and the two ends of an edge differ in every colour.
+    rng = random.Random(seed)
+    classes = [v % colors for v in range(num_vertices)]
+    rng.shuffle(classes)
+    candidates = [(u, v) for u in range(num_vertices) for v in range(u + 1, num_vertices)
+                  if classes[u] != classes[v]]
+    edges = rng.sample(candidates, min(num_edges, len(candidates)))
+
+    def var(v, c):
+        return v * colors + c + 1
+
+    clauses = []
+    for v in range(num_vertices):
+        for c in range(colors):
+            for d in range(c + 1, colors):
+                clauses.append([-var(v, c), -var(v, d)])
+        clauses.append([var(v, c) for c in range(colors)])
+    for u, v in sorted(edges):
+        for c in range(colors):
+            clauses.append([-var(u, c), -var(v, c)])
+    return num_vertices * colors, clauses
+
+
+def write_cnf(path, num_vars, clauses, comment=""):
+    with open(path, "w") as f:
+        if comment:
+            f.write(f"c {comment}\n")
+        f.write(f"p cnf {num_vars} {len(clauses)}\n")
+        for clause in clauses:
+            f.write(" ".join(map(str, clause)) + " 0\n")
+
+
+def generate(family, size, seed, ratio=None):
+    # One instance of a benchmark family. size is the number of variables for the k-SAT
+    # families and the number of vertices (edges = 2 * vertices, as in flat30) for
+    # graph colouring.
+    if family == "ksat":
+        return random_ksat(size, 4.26 if ratio is None else ratio, 3, seed)
+    if family == "planted":
+        return planted_ksat(size, 4.26 if ratio is None else ratio, 3, seed)
+    if family == "flat":
+        return flat_coloring(size, 2 * size, 3, seed)
+    raise ValueError(f"unknown family {family}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Generate benchmark CNF instances.")
+    parser.add_argument("family", choices=["ksat", "planted", "flat"])
+    parser.add_argument("size", type=int, help="variables (ksat, planted) or vertices (flat)")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--ratio", type=float, default=None, help="clause/variable ratio (default 4.26)")
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+    num_vars, clauses = generate(args.family, args.size, args.seed, args.ratio)
+    write_cnf(args.output, num_vars, clauses, f"{args.family} size={args.size} seed={args.seed}")
+    print(f"Wrote {len(clauses)} clauses over {num_vars} variables to {args.output}")
@@ -0,0 +1,184 @@
+// DPLL + CDCL + VSIDS: instrumentation builds (see profile.h)
+
+#define SAT_BUILDING_LIBRARY
+#include "profile.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <new>
+
+#if defined(SAT_PROFILE) && defined(__linux__)
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define SAT_HAVE_PERF_EVENTS 1
+#endif
+
+using namespace std;
+
+#ifdef SAT_PROFILE
+const char* const PHASE_NAMES[] = {"other", "parse", "preprocess", "propagate", "analyze", "decide", "reduce", "search"};
+atomic<bool> perf_counters_requested(false);
+
+// Profilers of the running threads, and the totals of the threads that have finished.
+static mutex& registry_mutex() { static mutex m; return m; }
+static vector<PhaseProfiler*>& registry() { static vector<PhaseProfiler*> r; return r; }
+static PhaseTotals& retired() { static PhaseTotals t; return t; }
+static int& counters_failed() { static int error = 0; return error; }      // errno of a failed open
+
+PhaseProfiler::PhaseProfiler() : current(Phase::Other), last_tick(profile_ticks()), perf_fd(-1) {
+    ticks_per_second();
+    if (perf_counters_requested)
+        open_counters();
+    lock_guard<mutex> lock(registry_mutex());
+    registry().push_back(this);
+}
+
+PhaseProfiler::~PhaseProfiler() {
+    switch_to(current);
+    lock_guard<mutex> lock(registry_mutex());
+    retired().add(totals);
+    registry().erase(find(registry().begin(), registry().end(), this));
+#ifdef SAT_HAVE_PERF_EVENTS
+    if (perf_fd >= 0)
+        close(perf_fd);
+#endif
+}
+
+PhaseTotals PhaseProfiler::collect(int& counter_error) {
+    PhaseProfiler& self = local();
+    self.switch_to(self.current);
+    lock_guard<mutex> lock(registry_mutex());
+    PhaseTotals sum = retired();
+    for (PhaseProfiler* profiler : registry())
+        sum.add(profiler->totals);
+    counter_error = counters_failed();
+    return sum;
+}
+
+double PhaseProfiler::ticks_per_second() {
+    static const uint64_t start_tick = profile_ticks();
+    static const auto start_time = chrono::steady_clock::now();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+#if defined(__x86_64__) || defined(__i386__)
+    return seconds > 0 ? (profile_ticks() - start_tick) / seconds : 1e9;
+#else
+    return (double)chrono::steady_clock::period::den / chrono::steady_clock::period::num;
+#endif
+}
+
+void PhaseProfiler::open_counters() {
+#ifdef SAT_HAVE_PERF_EVENTS
+    const uint64_t events[PERF_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    for (int c = 0; c < PERF_COUNTERS; c++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = events[c];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.disabled = (c == 0);
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, c == 0 ? -1 : perf_fd, 0);
+        if (fd < 0) {
+            if (perf_fd >= 0)
+                close(perf_fd);
+            perf_fd = -1;
+            counters_failed() = errno;
+            return;
+        }
+        if (c == 0)
+            perf_fd = fd;
+    }
+    ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    read_counters(last_counters);
+#else
+    counters_failed() = ENOSYS;
+#endif
+}
+
+bool PhaseProfiler::read_counters(uint64_t values[PERF_COUNTERS]) {
+#ifdef SAT_HAVE_PERF_EVENTS
+    uint64_t buffer[1 + PERF_COUNTERS];
+    if (::read(perf_fd, buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer) || buffer[0] != PERF_COUNTERS)
+        return false;
+    copy(buffer + 1, buffer + 1 + PERF_COUNTERS, values);
+    return true;
+#else
+    (void)values;
+    return false;
+#endif
+}
+
+void print_profile(ostream& out) {
+    int counter_error;
+    PhaseTotals totals = PhaseProfiler::collect(counter_error);
+    double rate = PhaseProfiler::ticks_per_second();
+    uint64_t all = 0;
+    for (int p = 0; p < PHASES; p++)
+        all += totals.ticks[p];
+    bool counters = perf_counters_requested && counter_error == 0;
+    ios_base::fmtflags flags = out.flags();
+    out << "Profile:\n";
+    out << "  " << left << setw(12) << "phase" << right << setw(12) << "seconds" << setw(8) << "share" << setw(14) << "entries";
+    if (counters)
+        out << setw(16) << "cycles" << setw(16) << "instructions" << setw(7) << "IPC" << setw(14) << "cache-misses" << setw(15) << "branch-misses";
+    out << "\n";
+    for (int p = 0; p < PHASES; p++) {
+        if (totals.ticks[p] == 0 && totals.entries[p] == 0)
+            continue;
+        out << "  " << left << setw(12) << PHASE_NAMES[p] << right << fixed
+            << setw(12) << setprecision(6) << totals.ticks[p] / rate
+            << setw(7) << setprecision(1) << (all ? 100.0 * totals.ticks[p] / all : 0.0) << "%"
+            << setw(14) << totals.entries[p];
+        if (counters) {
+            const uint64_t* c = totals.counters[p];
+            out << setw(16) << c[0] << setw(16) << c[1] << setw(7) << setprecision(2) << (c[0] ? (double)c[1] / c[0] : 0.0)
+                << setw(14) << c[2] << setw(15) << c[3];
+        }
+        out << "\n";
+    }
+    out.flags(flags);
+    if (perf_counters_requested && counter_error != 0)
+        out << "  Hardware counters unavailable: " << strerror(counter_error)
+            << " (needs a PMU and perf_event_paranoid <= 2)\n";
+}
+#endif
+
+#ifdef SAT_ALLOC_CHECK
+thread_local AllocationMode allocation_mode = AllocationMode::Off;
+atomic<uint64_t> search_allocations{0};
+
+void* operator new(size_t size) {
+    if (allocation_mode == AllocationMode::Search)
+        search_allocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+// Every form of delete ends here. Kept out of line: inlined into a sized delete, the
+// free() of a block from operator new trips -Wmismatched-new-delete.
+[[gnu::noinline]] static void release_allocation(void* p) noexcept { free(p); }
+
+void operator delete(void* p) noexcept { release_allocation(p); }
+void operator delete(void* p, size_t) noexcept { release_allocation(p); }
+void operator delete[](void* p) noexcept { release_allocation(p); }
+void operator delete[](void* p, size_t) noexcept { release_allocation(p); }
+
+bool print_allocations(ostream& out, long long dropped_learned) {
+    out << "Allocations: search " << search_allocations.load() << ", learned clauses dropped " << dropped_learned << "\n";
+    return search_allocations.load() == 0;
+}
+#endif
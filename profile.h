@@ -0,0 +1,165 @@
+// DPLL + CDCL + VSIDS: instrumentation builds
+//
+// Phase profiling (-DSAT_PROFILE) and the allocation check (-DSAT_ALLOC_CHECK). In other
+// builds SAT_PHASE() and SAT_COUNT_ALLOCATIONS() compile to nothing. Both builds link the
+// library sources into the executable (make profile, make alloc), so the thread-local
+// state below exists once per process.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include "satsolver.h"
+
+#ifdef SAT_PROFILE
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+//--------------------------------------------------------------
+// Phase profiling, compiled in with -DSAT_PROFILE
+//--------------------------------------------------------------
+
+// Where the solver spends its time. Each thread keeps one current phase; SAT_PHASE()
+// switches to a phase for the rest of the enclosing scope and back at its end, so a
+// nested phase's time is not also counted in the outer one.
+enum class Phase { Other, Parse, Preprocess, Propagate, Analyze, Decide, Reduce, Search, Count };
+
+#ifdef SAT_PROFILE
+const int PHASES = (int)Phase::Count;
+const int PERF_COUNTERS = 4;        // Cycles, instructions, cache misses, branch misses
+
+// Set by --perf-counters before the first phase switch of any thread.
+SAT_API extern std::atomic<bool> perf_counters_requested;
+
+inline uint64_t profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+struct PhaseTotals {
+    uint64_t ticks[PHASES] = {};
+    uint64_t entries[PHASES] = {};
+    uint64_t counters[PHASES][PERF_COUNTERS] = {};
+
+    void add(const PhaseTotals& other) {
+        for (int p = 0; p < PHASES; p++) {
+            ticks[p] += other.ticks[p];
+            entries[p] += other.entries[p];
+            for (int c = 0; c < PERF_COUNTERS; c++)
+                counters[p][c] += other.counters[p][c];
+        }
+    }
+};
+
+// Per-thread phase clock. The counters, if requested, are one perf_event group of the
+// thread's user-space events, read with one read() per phase switch; that read is
+// charged to the phases' timers, so compare phases by counters rather than seconds
+// when counters are on. Phase switches are inline; the rest is in profile.cpp.
+class SAT_API PhaseProfiler {
+public:
+    static PhaseProfiler& local() {
+        thread_local PhaseProfiler profiler;
+        return profiler;
+    }
+
+    Phase switch_to(Phase phase) {
+        uint64_t now = profile_ticks();
+        int p = (int)current;
+        totals.ticks[p] += now - last_tick;
+        last_tick = now;
+        if (perf_fd >= 0) {
+            uint64_t values[PERF_COUNTERS];
+            if (read_counters(values)) {
+                for (int c = 0; c < PERF_COUNTERS; c++) {
+                    totals.counters[p][c] += values[c] - last_counters[c];
+                    last_counters[c] = values[c];
+                }
+            }
+        }
+        totals.entries[(int)phase]++;
+        Phase previous = current;
+        current = phase;
+        return previous;
+    }
+
+    // Totals of all threads, finished ones included. counter_error is the errno of the
+    // kernel refusing requested counters on some thread, else 0.
+    static PhaseTotals collect(int& counter_error);
+
+    // TSC ticks per second, measured over the life of the process.
+    static double ticks_per_second();
+
+private:
+    PhaseProfiler();
+    ~PhaseProfiler();
+
+    void open_counters();
+    bool read_counters(uint64_t values[PERF_COUNTERS]);
+
+    Phase current;
+    uint64_t last_tick;
+    int perf_fd;
+    uint64_t last_counters[PERF_COUNTERS] = {};
+    PhaseTotals totals;
+};
+
+class ScopedPhase {
+public:
+    explicit ScopedPhase(Phase phase) : profiler(PhaseProfiler::local()), previous(profiler.switch_to(phase)) {}
+    ~ScopedPhase() { profiler.switch_to(previous); }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+private:
+    PhaseProfiler& profiler;
+    Phase previous;
+};
+
+#define SAT_PHASE(phase) ScopedPhase phase_scope_(Phase::phase)
+
+// Per-phase table printed after a solve in profiling builds.
+SAT_API void print_profile(std::ostream& out);
+#else
+#define SAT_PHASE(phase) ((void)0)
+#endif
+
+// ---------------------------------------------------------------------------
+// Allocation check build
+// ---------------------------------------------------------------------------
+// Compiled with -DSAT_ALLOC_CHECK, the global operator new counts the allocations a
+// thread makes inside a SAT_COUNT_ALLOCATIONS(Search) scope, which covers the search
+// loop with its restarts and inprocessing. SAT_COUNT_ALLOCATIONS(Off) exempts the code
+// the search calls out to (snapshots, model callbacks). Otherwise the macro is a no-op.
+
+#ifdef SAT_ALLOC_CHECK
+enum class AllocationMode { Off, Search };
+
+SAT_API extern thread_local AllocationMode allocation_mode;
+
+class ScopedAllocationMode {
+public:
+    explicit ScopedAllocationMode(AllocationMode mode) : previous(allocation_mode) { allocation_mode = mode; }
+    ~ScopedAllocationMode() { allocation_mode = previous; }
+    ScopedAllocationMode(const ScopedAllocationMode&) = delete;
+    ScopedAllocationMode& operator=(const ScopedAllocationMode&) = delete;
+private:
+    AllocationMode previous;
+};
+
+#define SAT_COUNT_ALLOCATIONS(mode) ScopedAllocationMode allocation_scope_(AllocationMode::mode)
+
+// Counts printed after a solve, with the learned clauses the search dropped rather than
+// allocate for (see DPLLSolver_DS::add_learned_clause); false if the search allocated.
+SAT_API bool print_allocations(std::ostream& out, long long dropped_learned);
+#else
+#define SAT_COUNT_ALLOCATIONS(mode) ((void)0)
+#endif
+
+#endif
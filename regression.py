@@ -0,0 +1,303 @@
+import argparse
+import glob
+import os
+import random
+import re
+import subprocess
+import sys
+import tempfile
+import satsolver
+from generate_cnf import random_ksat, write_cnf
+
+# Regression checks for DPLL_CDCL_VSIDS. Every answer is checked independently of the
+# solver where that is possible: models against the clauses, model counts against
+# brute force, and cores by solving them again. The script exits with status 1 if any
+# check fails.
+
+benchmark_folder = "benchmark_files"
+failures = []
+
+def read_cnf(path):
+    num_vars, clauses, clause = 0, [], []
+    with open(path) as f:
+        for line in f:
+            tokens = line.split()
+            if tokens and tokens[0] == "%":
+                break           # SATLIB end marker, followed by a stray 0
+            if not tokens or tokens[0] == "c":
+                continue
+            if tokens[0] == "p":
+                num_vars = int(tokens[2])
+                continue
+            for lit in map(int, tokens):
+                if lit == 0:
+                    clauses.append(clause)
+                    clause = []
+                else:
+                    clause.append(lit)
+    return num_vars, clauses
+
+def run(solver, args, timeout):
+    result = subprocess.run([solver] + args, capture_output=True, text=True, timeout=timeout)
+    if result.returncode != 0:
+        raise RuntimeError(f"{' '.join(args)} exited with {result.returncode}: {result.stderr.strip()}")
+    return result.stdout
+
+def fail(check, message):
+    failures.append(f"{check}: {message}")
+    print(f"FAIL {check}: {message}")
+
+def parse_result(output):
+    match = re.search(r"^RESULT: (\w+)", output, re.M)
+    return match.group(1) if match else None
+
+# Model from an "ASSIGNMENT: v=0/1 ..." line, as a set of true literals.
+def parse_assignment(line):
+    return {int(v) if b == "1" else -int(v) for v, b in re.findall(r"(\d+)=([01])", line)}
+
+def parse_model(output):
+    match = re.search(r"^ASSIGNMENT:(.*)$", output, re.M)
+    return parse_assignment(match.group(1)) if match else None
+
+def satisfies(clauses, model):
+    return all(any(lit in model for lit in clause) for clause in clauses)
+
+# Bit a of the result is set if assignment a satisfies every clause, where variable v
+# is bit v - 1 of a. Python integers work as 2^n-bit vectors, so this is fast up to
+# about 22 variables.
+def model_bits(num_vars, clauses):
+    size = 1 << num_vars
+    full = (1 << size) - 1
+    true_bits = [0]
+    for v in range(1, num_vars + 1):
+        block = ((1 << (1 << (v - 1))) - 1) << (1 << (v - 1))    # 0...01...1 of period 2^v
+        pattern, period = block, 1 << v
+        while period < size:
+            pattern |= pattern << period
+            period *= 2
+        true_bits.append(pattern & full)
+    models = full
+    for clause in clauses:
+        satisfied = 0
+        for lit in clause:
+            satisfied |= true_bits[lit] if lit > 0 else full ^ true_bits[-lit]
+        models &= satisfied
+    return models, true_bits
+
+# Number of distinct restrictions of the models to the projected variables: fold every
+# other variable's true half onto its false half.
+def projected_count(num_vars, models, true_bits, projected):
+    for v in range(1, num_vars + 1):
+        if v not in projected:
+            models = (models & ~true_bits[v]) | ((models & true_bits[v]) >> (1 << (v - 1)))
+    return bin(models).count("1")
+
+# Solve every file; SAT answers must come with a model that satisfies the clauses.
+def check_solve(solver, files, args, timeout, label):
+    statuses = {}
+    for path in files:
+        _, clauses = read_cnf(path)
+        output = run(solver, args + [path], timeout)
+        status = parse_result(output)
+        statuses[path] = status
+        if status == "SAT":
+            model = parse_model(output)
+            if model is None or not satisfies(clauses, model):
+                fail(label, f"{path}: model does not satisfy the clauses")
+        elif status != "UNSAT":
+            fail(label, f"{path}: no answer ({status})")
+    return statuses
+
+# All files in one --multiplex 1 run, one conflict per step: same answers as the
+# normal solve and valid models.
+def check_multiplex(solver, files, expected, timeout):
+    output = run(solver, ["--multiplex", "1"] + files, timeout)
+    lines = output.splitlines()
+    reported = set()
+    for i, line in enumerate(lines):
+        match = re.match(r"^(\S+): (SAT|UNSAT|UNKNOWN) ", line)
+        if not match:
+            continue
+        path, status = match.groups()
+        reported.add(path)
+        if status != expected.get(path):
+            fail("multiplex", f"{path}: {status}, normal solve says {expected.get(path)}")
+        if status == "SAT":
+            _, clauses = read_cnf(path)
+            model = parse_assignment(lines[i + 1]) if i + 1 < len(lines) and lines[i + 1].startswith("ASSIGNMENT:") else None
+            if model is None or not satisfies(clauses, model):
+                fail("multiplex", f"{path}: model does not satisfy the clauses")
+    for path in files:
+        if path not in reported:
+            fail("multiplex", f"{path}: no result line")
+
+# Independent random 3-SAT components solved through the library with a conflict
+# limit: the component solvers share the limit, so that together they stop within it.
+# Without a limit, --workers 1 must give the library's answer.
+def check_component_budget(solver, rng, timeout, workdir):
+    path = os.path.join(workdir, "components.cnf")
+    for _ in range(3):
+        num_vars, copies, clauses = 100, 4, []
+        for c in range(copies):
+            _, part = random_ksat(num_vars, 4.26, 3, rng.randrange(1 << 30))
+            clauses += [[lit + c * num_vars if lit > 0 else lit - c * num_vars for lit in clause] for clause in part]
+        for limit in (1, 10, 100, -1):
+            with satsolver.Solver() as s:
+                s.add_clauses(clauses)
+                status = s.solve(limit)
+                conflicts, components = s.statistic("conflicts"), s.statistic("components")
+            if components < copies:
+                fail("components", f"{components:.0f} components, expected {copies}")
+            if limit >= 0 and conflicts > limit:
+                fail("components", f"{conflicts:.0f} conflicts with --conflict-limit {limit}")
+        write_cnf(path, num_vars * copies, clauses)
+        output = run(solver, ["--workers", "1", path], timeout)
+        if parse_result(output) != status:
+            fail("components", f"--workers 1: {parse_result(output)}, library says {status}")
+        elif status == "SAT" and not satisfies(clauses, parse_model(output) or set()):
+            fail("components", "--workers 1: model does not satisfy the clauses")
+
+# The result cache is keyed by the normalised clause set: a formula with a repeated
+# literal and a tautology, written as DIMACS or as .bcnf, must hit the entry stored for
+# its plain form.
+def check_cache(solver, timeout, workdir):
+    cache = os.path.join(workdir, "cache")
+    plain, noisy, binary = (os.path.join(workdir, name) for name in ("plain.cnf", "noisy.cnf", "noisy.bcnf"))
+    write_cnf(plain, 3, [[1, 2], [-1, 3], [-2, -3]])
+    write_cnf(noisy, 3, [[-3, -2], [1, 1, 2], [3, -1, 3], [2, -2, 3]])
+    run(solver, ["--write-binary", binary, noisy], timeout)
+    run(solver, ["--cache", cache, plain], timeout)
+    for path in (noisy, binary):
+        output = run(solver, ["--cache", cache, path], timeout)
+        if not re.search(r"^Cache: hit ", output, re.M):
+            fail("cache", f"{os.path.basename(path)}: no hit on the entry of the same formula without repeats")
+
+# --count, --count --project and --all-models against brute force.
+def check_counts(solver, files, timeout, rng):
+    for path in files:
+        num_vars, clauses = read_cnf(path)
+        models, true_bits = model_bits(num_vars, clauses)
+        projections = [set(range(1, num_vars + 1))]
+        for size in (1, 5, 10):
+            projections.append(set(rng.sample(range(1, num_vars + 1), size)))
+        for projected in projections:
+            args = ["--count"]
+            if len(projected) < num_vars:
+                args += ["--project", ",".join(map(str, sorted(projected)))]
+            match = re.search(r"^MODELS: (\d+)$", run(solver, args + [path], timeout), re.M)
+            expected = projected_count(num_vars, models, true_bits, projected)
+            if not match or int(match.group(1)) != expected:
+                fail("count", f"{path} {' '.join(args)}: {match.group(1) if match else 'no count'}, brute force {expected}")
+        output = run(solver, ["--all-models", path], timeout)
+        listed = [frozenset(map(int, line.split()[1:-1])) for line in output.splitlines() if line.startswith("v ")]
+        # A listed cube may leave variables free; it then stands for 2^free models.
+        covered = sum(1 << (num_vars - len(cube)) for cube in listed)
+        if len(set(listed)) != len(listed) or not all(satisfies(clauses, cube) for cube in listed) or covered != bin(models).count("1"):
+            fail("all-models", f"{path}: {len(listed)} cubes covering {covered} models, brute force {bin(models).count('1')}")
+
+def parse_core(output):
+    match = re.search(r"^CORE:(.*)$", output, re.M)
+    return [int(i) for i in match.group(1).split()] if match else None
+
+def write_subset(path, num_vars, clauses, ids):
+    write_cnf(path, num_vars, [clauses[i - 1] for i in ids])
+
+# The clauses of a --core are UNSAT on their own; with --minimize-core, dropping any
+# one of them makes the rest SAT.
+def check_cores(solver, files, minimize_files, timeout, workdir):
+    for path in files:
+        num_vars, clauses = read_cnf(path)
+        minimize = path in minimize_files
+        core = parse_core(run(solver, ["--minimize-core" if minimize else "--core", path], timeout))
+        if not core:
+            fail("core", f"{path}: no core")
+            continue
+        subset = os.path.join(workdir, "core.cnf")
+        write_subset(subset, num_vars, clauses, core)
+        if parse_result(run(solver, [subset], timeout)) != "UNSAT":
+            fail("core", f"{path}: the core is not UNSAT")
+        if minimize:
+            for dropped in core:
+                write_subset(subset, num_vars, clauses, [i for i in core if i != dropped])
+                if parse_result(run(solver, [subset], timeout)) != "SAT":
+                    fail("minimize-core", f"{path}: clause {dropped} can be dropped from the core")
+                    break
+
+# Random formulas with equivalence chains and failed literals, which give substitution
+# and failed-literal probing work; restarting after every conflict runs vivification
+# between restarts as often as possible. Up to 16 variables the answer comes from brute
+# force. Every fourth formula has 40 to 70 variables, so that the search gets to
+# restart and vivify; its answer comes from a run with the default parameters.
+def fuzz(solver, count, rng, timeout, workdir):
+    config = os.path.join(workdir, "fuzz.cfg")
+    with open(config, "w") as f:
+        f.write("restart_base = 1\nrestart_growth = 1\ninprocess_effort = 1\n")
+    path = os.path.join(workdir, "fuzz.cnf")
+    for i in range(count):
+        large = (i % 4 == 3)
+        num_vars = rng.randint(40, 70) if large else rng.randint(6, 16)
+        _, clauses = random_ksat(num_vars, rng.uniform(2.5, 5.0), 3, rng.randrange(1 << 30))
+        for _ in range(rng.randint(0, num_vars // 2)):
+            a, b = rng.sample(range(1, num_vars + 1), 2)
+            b = b if rng.random() < 0.5 else -b
+            clauses += [[-a, b], [a, -b]]
+        if rng.random() < 0.3:
+            a, b = rng.sample(range(1, num_vars + 1), 2)
+            clauses += [[-a, b], [-a, -b]]      # a is a failed literal
+        rng.shuffle(clauses)
+        write_cnf(path, num_vars, clauses)
+        if large:
+            expected, reference = parse_result(run(solver, [path], timeout)), "default parameters"
+        else:
+            expected, reference = ("SAT" if model_bits(num_vars, clauses)[0] else "UNSAT"), "brute force"
+        for args in ([], ["--config", config], ["--config", config, "--heuristic", "lookahead"], ["--reorder"]):
+            output = run(solver, args + [path], timeout)
+            status = parse_result(output)
+            model = parse_model(output) if status == "SAT" else None
+            if status != expected or (model is not None and not satisfies(clauses, model)):
+                kept = f"fuzz_failure_{i}.cnf"
+                write_cnf(os.path.join(workdir, kept), num_vars, clauses)
+                fail("fuzz", f"{' '.join(args)} {kept}: {status}, {reference} {expected}" +
+                     (" (bad model)" if status == expected else ""))
+                break
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Regression checks for DPLL_CDCL_VSIDS.")
+    parser.add_argument("--solver", default="./DPLL_CDCL_VSIDS")
+    parser.add_argument("--timeout", type=float, default=300, help="seconds per solver run")
+    parser.add_argument("--fuzz", type=int, default=200, help="random formulas for the inprocessing fuzz")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+    rng = random.Random(args.seed)
+
+    files = sorted(glob.glob(os.path.join(benchmark_folder, "*.cnf")))
+    uf20 = [f for f in files if os.path.basename(f).startswith("uf20-")]
+    uuf = [f for f in files if os.path.basename(f).startswith("uuf")]
+    uuf50 = [f for f in uuf if os.path.basename(f).startswith("uuf50-")]
+
+    with tempfile.TemporaryDirectory() as workdir:
+        print("Solving the benchmark files")
+        expected = check_solve(args.solver, files, [], args.timeout, "solve")
+        print("Checking --multiplex 1 against the normal solve")
+        check_multiplex(args.solver, files, expected, args.timeout)
+        print("Checking models with --reorder")
+        for path, status in check_solve(args.solver, files, ["--reorder"], args.timeout, "reorder").items():
+            if status != expected[path]:
+                fail("reorder", f"{path}: {status}, normal solve says {expected[path]}")
+        print("Checking model counts on uf20 against brute force")
+        check_counts(args.solver, uf20, args.timeout, rng)
+        print("Checking result cache keys")
+        check_cache(args.solver, args.timeout, workdir)
+        print("Checking the conflict limit shared by component solvers")
+        check_component_budget(args.solver, rng, args.timeout, workdir)
+        print("Checking UNSAT cores")
+        check_cores(args.solver, uuf, uuf50, args.timeout, workdir)
+        print(f"Fuzzing inprocessing with {args.fuzz} random formulas")
+        fuzz(args.solver, args.fuzz, rng, args.timeout, workdir)
+        if failures:
+            # Keep the failing fuzz formulas.
+            for kept in glob.glob(os.path.join(workdir, "fuzz_failure_*.cnf")):
+                os.replace(kept, os.path.basename(kept))
+
+    print(f"{len(failures)} failures" if failures else "All checks passed")
+    sys.exit(1 if failures else 0)
@@ -3,11 +3,10 @@
 # SAT Solver executable (make this a variable)
 sat_solver_name="DPLL_CDCL_VSIDS" # Changed to just the name
 sat_solver_exe="./$sat_solver_name" # Prepend "./"
-sat_solver_cpp="$sat_solver_name.cpp" # Added source file variable
 
-# Compile the SAT solver
-echo "Compiling $sat_solver_cpp..."
-g++ -std=c++17 -O2 "$sat_solver_cpp" -o "$sat_solver_exe"
+# Compile the SAT solver (DPLL_CDCL_VSIDS also builds libsatsolver.so)
+echo "Compiling $sat_solver_name..."
+make "$sat_solver_name"
 
 if [ $? -ne 0 ]; then
     echo "Compilation failed. Exiting."
@@ -0,0 +1,3183 @@
+// DPLL + CDCL + VSIDS: the solver library
+//
+// Built as libsatsolver.so (make), or linked into the executable by the instrumented
+// builds (make profile, make alloc). solver.h declares the C++ interface; the C API of
+// satsolver.h is at the end of this file.
+
+#define SAT_BUILDING_LIBRARY
+#include "solver.h"
+#include "profile.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <cmath>
+#include <climits>
+#include <cstring>
+#include <cerrno>
+#include <deque>
+#include <exception>
+#include <new>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <malloc.h>
+#include <sched.h>
+#define SAT_HAVE_MMAP 1
+#define SAT_HAVE_AFFINITY 1
+#endif
+
+using namespace std;
+
+//--------------------------------------------------------------
+// Huge-page memory and NUMA placement
+//--------------------------------------------------------------
+
+// What backs an array: explicit 2 MB huge pages, anonymous memory advised for
+// transparent huge pages, plain 4 KB pages, or the ordinary heap (small arrays).
+enum class PageBacking { Hugetlb, Transparent, SmallPages, Heap, Count };
+const int PAGE_BACKINGS = (int)PageBacking::Count;
+const char* const PAGE_BACKING_NAMES[PAGE_BACKINGS] = {"2 MB huge pages", "transparent huge pages", "4 KB pages", "heap"};
+const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+// Bytes per backing held by LargePageAllocator over the whole process, and their peaks.
+atomic<size_t> page_backing_bytes[PAGE_BACKINGS];
+atomic<size_t> page_backing_peak[PAGE_BACKINGS];
+
+inline void note_page_backing(PageBacking backing, ptrdiff_t bytes) {
+    size_t now = page_backing_bytes[(int)backing] += bytes;
+    size_t peak = page_backing_peak[(int)backing];
+    while (now > peak && !page_backing_peak[(int)backing].compare_exchange_weak(peak, now)) {}
+}
+
+// Whether madvise(MADV_HUGEPAGE) has an effect: THP set to "always" or "madvise".
+inline bool transparent_huge_pages_enabled() {
+    static const bool enabled = [] {
+        ifstream in("/sys/kernel/mm/transparent_hugepage/enabled");
+        string line;
+        return getline(in, line) && line.find("[never]") == string::npos;
+    }();
+    return enabled;
+}
+
+// The backing of a mapped array is kept in a header in front of it.
+const size_t LARGE_PAGE_HEADER = 64;            // Keeps the array cache-line aligned
+
+void* large_page_allocate(size_t bytes) {
+#ifdef SAT_HAVE_MMAP
+    if (bytes + LARGE_PAGE_HEADER >= HUGE_PAGE_SIZE) {
+        size_t length = (bytes + LARGE_PAGE_HEADER + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        PageBacking backing = PageBacking::Hugetlb;
+        void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base == MAP_FAILED) {
+            base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED)
+                throw bad_alloc();
+            backing = (transparent_huge_pages_enabled() && madvise(base, length, MADV_HUGEPAGE) == 0 ?
+                       PageBacking::Transparent : PageBacking::SmallPages);
+        }
+        *static_cast<PageBacking*>(base) = backing;
+        note_page_backing(backing, (ptrdiff_t)length);
+        return static_cast<char*>(base) + LARGE_PAGE_HEADER;
+    }
+#endif
+    note_page_backing(PageBacking::Heap, (ptrdiff_t)bytes);
+    return ::operator new(bytes);
+}
+
+void large_page_release(void* p, size_t bytes) {
+#ifdef SAT_HAVE_MMAP
+    if (bytes + LARGE_PAGE_HEADER >= HUGE_PAGE_SIZE) {
+        size_t length = (bytes + LARGE_PAGE_HEADER + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        char* base = static_cast<char*>(p) - LARGE_PAGE_HEADER;
+        note_page_backing(*reinterpret_cast<PageBacking*>(base), -(ptrdiff_t)length);
+        munmap(base, length);
+        return;
+    }
+#endif
+    note_page_backing(PageBacking::Heap, -(ptrdiff_t)bytes);
+    ::operator delete(p);
+}
+
+// CPUs of each NUMA node, from sysfs; one node holding every CPU where that is unknown.
+inline const vector<vector<int>>& numa_nodes() {
+    static const vector<vector<int>> nodes = [] {
+        vector<vector<int>> found;
+        for (int node = 0; ; node++) {
+            ifstream in("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+            string list;
+            if (!in || !getline(in, list))
+                break;
+            vector<int> cpus;
+            istringstream ranges(list);
+            string range;
+            while (getline(ranges, range, ',')) {
+                int first = 0, last = 0;
+                if (sscanf(range.c_str(), "%d-%d", &first, &last) == 1)
+                    last = first;
+                for (int cpu = first; cpu <= last; cpu++)
+                    cpus.push_back(cpu);
+            }
+            if (!cpus.empty())
+                found.push_back(cpus);
+        }
+        if (found.empty())
+            found.push_back({});
+        return found;
+    }();
+    return nodes;
+}
+
+// Workers restricted to one NUMA node so far (see bind_worker_to_numa_node()).
+atomic<int> numa_bound_workers(0);
+
+void bind_worker_to_numa_node(size_t index) {
+    const auto& nodes = numa_nodes();
+    if (nodes.size() < 2)
+        return;
+#ifdef SAT_HAVE_AFFINITY
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : nodes[index % nodes.size()])
+        CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == 0)
+        numa_bound_workers++;
+#endif
+}
+
+string memory_backing_summary() {
+    ostringstream out;
+    for (int b = 0; b < (int)PageBacking::Heap; b++) {
+        size_t peak = page_backing_peak[b];
+        if (peak > 0)
+            out << (out.tellp() > 0 ? ", " : "Memory backing: ") << PAGE_BACKING_NAMES[b] << " " << fixed
+                << setprecision(1) << peak / 1048576.0 << " MB";
+    }
+    if (out.tellp() == 0)
+        return "";
+    out << "; NUMA nodes: " << numa_nodes().size();
+    if (numa_bound_workers > 0)
+        out << ", " << numa_bound_workers << " workers bound to nodes";
+    return out.str();
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+double get_memory_usage() {
+    PROCESS_MEMORY_COUNTERS memCounters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &memCounters, sizeof(memCounters))) {
+        return memCounters.WorkingSetSize / (1024.0); // bytes to KB
+    }
+    return 0.0;
+}
+#elif defined(__linux__)
+double get_memory_usage() {
+    std::ifstream status_file("/proc/" + std::to_string(getpid()) + "/status");
+    std::string line;
+    while (std::getline(status_file, line)) {
+        if (line.find("VmRSS:") == 0) {
+            std::stringstream ss(line.substr(6));
+            long long memory_kb;
+            ss >> memory_kb;
+            return (memory_kb);     // already in KB
+        }
+    }
+    std::cerr << "Error: Could not read VmRSS from /proc/self/status on Linux." << std::endl;
+    return -1;
+}
+#else
+double get_memory_usage() {
+    std::cerr << "Error: Memory usage measurement is not implemented for this platform." << std::endl;
+    return -1;
+}
+#endif
+
+//--------------------------------------------------------------
+// Search traces
+//--------------------------------------------------------------
+
+// Binary search trace ("SATTRCE1"): magic[8], the formula key (hi, lo as little-endian
+// u64), then the search's events in order. Each event is a one-byte tag, followed by
+// a LEB128 varint except for 'C' and 'U':
+//   'D' lit   decision, 0 if the node had none (literals zigzag-encoded)
+//   'P' lit   lookahead probe: lit propagated on a scratch trail ...
+//   'U'       ... and undone (probes nest, as in double lookahead)
+//   'F' lit   literal forced by a failed lookahead before the next decision
+//   'C'       conflict
+//   'L' id    learned clause added at clause index id
+//   'R' n     restart, after which n - 1 clauses were vivified (0: no inprocessing)
+//   'E' s     end of the search: 1 SAT, 2 UNSAT
+const char TRACE_MAGIC[8] = {'S', 'A', 'T', 'T', 'R', 'C', 'E', '1'};
+
+inline uint64_t zigzag(int literal) {
+    return (uint32_t)(((uint32_t)literal << 1) ^ (uint32_t)(literal >> 31));
+}
+
+inline int unzigzag(uint64_t value) {
+    return (int)((uint32_t)(value >> 1) ^ (uint32_t)-(int64_t)(value & 1));
+}
+
+// An event as text, for messages: "D -12", "C".
+inline string trace_event_text(char tag, uint64_t value) {
+    if (tag == 'C' || tag == 'U')
+        return string(1, tag);
+    bool literal = (tag == 'D' || tag == 'P' || tag == 'F');
+    return string(1, tag) + " " + (literal ? to_string(unzigzag(value)) : to_string(value));
+}
+
+// Writes a trace through a large buffer; the solver records an event per decision and
+// per conflict, so writes must stay cheap.
+class TraceWriter {
+public:
+    TraceWriter(const string& path, const FormulaKey& key, size_t capacity = 1 << 20)
+        : out(fopen(path.c_str(), "wb")), capacity(capacity), count(0) {
+        if (!out)
+            throw runtime_error("Error: Could not create trace file " + path + ".");
+        buffer.reserve(capacity + 16);
+        for (char c : TRACE_MAGIC)
+            buffer.push_back((uint8_t)c);
+        for (uint64_t half : {key.hi, key.lo})
+            for (int shift = 0; shift < 64; shift += 8)
+                buffer.push_back((uint8_t)(half >> shift));
+    }
+
+    ~TraceWriter() {
+        flush();
+        fclose(out);
+    }
+
+    void event(char tag, uint64_t value = 0) {
+        buffer.push_back((uint8_t)tag);
+        if (tag != 'C' && tag != 'U') {
+            while (value >= 0x80) {
+                buffer.push_back((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            buffer.push_back((uint8_t)value);
+        }
+        count++;
+        if (buffer.size() > capacity)
+            flush();
+    }
+
+    void flush() {
+        if (!buffer.empty())
+            fwrite(buffer.data(), 1, buffer.size(), out);
+        buffer.clear();
+        fflush(out);
+    }
+
+    long long events() const { return count; }
+
+private:
+    FILE* out;
+    size_t capacity;
+    vector<uint8_t> buffer;
+    long long count;
+};
+
+class TraceReader {
+public:
+    explicit TraceReader(const string& path) : position(24), count(0) {
+        ifstream in(path, ios::binary);
+        if (!in)
+            throw runtime_error("Error: Could not open trace file " + path + ".");
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        if (bytes.size() < 24 || !equal(TRACE_MAGIC, TRACE_MAGIC + 8, bytes.begin()))
+            throw runtime_error("Error: " + path + " is not a search trace.");
+        for (int shift = 0; shift < 64; shift += 8) {
+            formula.hi |= (uint64_t)bytes[8 + shift / 8] << shift;
+            formula.lo |= (uint64_t)bytes[16 + shift / 8] << shift;
+        }
+    }
+
+    const FormulaKey& key() const { return formula; }
+
+    // Next event; false at the end of the trace (or at a truncated event).
+    bool next(char& tag, uint64_t& value) {
+        size_t at = position;
+        if (!decode(at, tag, value))
+            return false;
+        position = at;
+        count++;
+        return true;
+    }
+
+    bool peek(char& tag, uint64_t& value) const {
+        size_t at = position;
+        return decode(at, tag, value);
+    }
+
+    long long events_read() const { return count; }
+
+private:
+    bool decode(size_t& at, char& tag, uint64_t& value) const {
+        if (at >= bytes.size())
+            return false;
+        tag = (char)bytes[at++];
+        value = 0;
+        if (tag == 'C' || tag == 'U')
+            return true;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (at >= bytes.size())
+                return false;
+            uint8_t byte = bytes[at++];
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    vector<uint8_t> bytes;
+    size_t position;
+    long long count;
+    FormulaKey formula;
+};
+
+
+// FNV-1a hash of a sorted literal vector.
+static uint64_t hash_literals(const vector<int>& lits) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int lit : lits)
+        h = (h ^ (uint32_t)lit) * 1099511628211ULL;
+    return h;
+}
+
+
+//--------------------------------------------------------------
+// DPLLSolver_DS members
+//--------------------------------------------------------------
+
+DPLLSolver_DS::DPLLSolver_DS(const vector<unordered_set<int>>& cnf_clauses,
+                             int learned_clause_limit_percentage,
+                             int max_learned_clause_len_param)
+    : DPLLSolver_DS(learned_clause_limit_percentage, max_learned_clause_len_param)
+{
+    vector<int> lits;
+    for (const auto& clause : cnf_clauses) {
+        lits.assign(clause.begin(), clause.end());
+        add_clause(lits.data(), lits.data() + lits.size());
+    }
+    finish_loading();
+}
+
+DPLLSolver_DS::~DPLLSolver_DS() {}
+
+DPLLSolver_DS::DPLLSolver_DS(int learned_clause_limit_percentage_param,
+                             int max_learned_clause_len_param)
+    : max_learned_clause_len(max_learned_clause_len_param + 1),
+      learned_clauses_count(0),
+      dropped_learned_clauses(0),
+      occurrences_full(false),
+      occurrence_headroom(0),
+      decay_factor(0.95),
+      conflict_weight(0.2),
+      decay_interval(10),
+      decision_count(0),
+      num_original_clauses(0),
+      root_conflict(false),
+      probe_budget(0),
+      propagation_visits(0),
+      conflicts(0),
+      restarts(0),
+      restart_base(5000),
+      restart_growth(2.0),
+      next_restart(5000),
+      restart_pending(false),
+      inprocess_effort(0.1),
+      search_seconds(0.0),
+      inprocess_seconds(0.0),
+      vivify_cursor(0),
+      formula_key_ready(false),
+      snapshot_interval(60.0),
+      last_snapshot(chrono::steady_clock::now()),
+      use_saved_phases(false),
+      use_lookahead(false),
+      decompose(true),
+      components_solved(0),
+      component_workers(0),
+      reorder(false),
+      order_fixed(false),
+      conflict_limit(-1),
+      shared_conflicts(nullptr),
+      holds_shared_conflict(false),
+      assignment_count(0),
+      assignment_limit(-1),
+      stepping(false),
+      step_status(SolveStatus::Unknown),
+      traced_events(0),
+      has_deadline(false),
+      cancel_flag(nullptr),
+      aborted(false),
+      limit_check_counter(0),
+      enumerating(false),
+      completing(false),
+      learned_clause_limit_percentage(learned_clause_limit_percentage_param),
+      input_literals(0),
+      input_clauses(0),
+      longest_clause(0),
+      core_tracking(false),
+      empty_clause_id(-1),
+      proof_start(1, 0),
+      core_scope(1),
+      core_episodes(1)
+{
+    num_vars = 0;
+    amo_extracted = false;
+    resize_variables(0);
+}
+
+void DPLLSolver_DS::add_clause(const int* begin, const int* end) {
+    int id = input_clauses++;
+    vector<int> lits(begin, end);
+    sort(lits.begin(), lits.end());
+    lits.erase(unique(lits.begin(), lits.end()), lits.end());
+    if (core_tracking)
+        tracked_inputs.push_back(lits);
+    for (size_t i = 0; i + 1 < lits.size(); i++) {
+        if (lits[i] < 0 && binary_search(lits.begin() + i + 1, lits.end(), -lits[i]))
+            return;
+    }
+    if (lits.empty()) {
+        if (empty_clause_id < 0)
+            empty_clause_id = id;
+        root_conflict = true;
+        return;
+    }
+    // A hash match is confirmed against the stored clause; on a genuine collision
+    // the clause is simply kept.
+    auto found = loaded_clauses.emplace(hash_literals(lits), (int)cnf.size());
+    if (!found.second) {
+        const DynamicClauses::Clause other = cnf[found.first->second];
+        if (other.size() == lits.size() && all_of(lits.begin(), lits.end(), [&other](int lit) { return other.count(lit) > 0; }))
+            return;
+    }
+    int max_var = max(abs(lits.front()), abs(lits.back()));
+    if (max_var > num_vars)
+        resize_variables(max_var);
+    longest_clause = max(longest_clause, lits.size());
+    int idx = (int)cnf.size();
+    cnf.push_back(lits);
+    original_cnf.push_back(lits);
+    clause_info.push_back(ClauseInfo(id));
+    unsatisfied_clauses.insert(idx);
+    for (int lit : lits)
+        occurrences[packed_literal(lit)].push_back(idx);
+    if (lits.size() == 1) {
+        input_units.push_back(lits[0]);
+        input_unit_ids.push_back(id);
+    }
+    input_literals += (long long)lits.size();
+    num_original_clauses++;
+}
+
+void DPLLSolver_DS::reserve_clauses(size_t count) {
+    cnf.reserve(count, 3 * count);
+    original_cnf.reserve(count, 3 * count);
+    clause_info.reserve(count);
+    loaded_clauses.reserve(count);
+}
+
+void DPLLSolver_DS::declare_variables(long long count) {
+    if (count > num_vars)
+        resize_variables((int)count);
+}
+
+int DPLLSolver_DS::value_of(int literal) const {
+    return lit_value[packed_literal(literal)];
+}
+
+void DPLLSolver_DS::finish_loading() {
+    loaded_clauses = {};
+    core_mark.resize(input_clauses, 0);
+    // Maximum learned clauses allowed.
+    max_learned_clauses = (int)(num_original_clauses * (learned_clause_limit_percentage / 100.0));
+    // Probing may visit each literal occurrence a few times per round.
+    probe_budget = 20 * input_literals + 10000;
+}
+
+void DPLLSolver_DS::set_formula_key(const FormulaKey& key, const FormulaShape& shape) {
+    formula_key = key;
+    formula_shape = shape;
+    formula_key_ready = true;
+}
+
+const FormulaKey& DPLLSolver_DS::get_formula_key() {
+    if (!formula_key_ready) {
+        formula_key = canonical_formula_key(original_cnf, num_original_clauses, &formula_shape);
+        formula_key_ready = true;
+    }
+    return formula_key;
+}
+
+const FormulaShape& DPLLSolver_DS::get_formula_shape() {
+    get_formula_key();
+    return formula_shape;
+}
+
+bool DPLLSolver_DS::solve() {
+    return solve_limited() == SolveStatus::Satisfiable;
+}
+
+void DPLLSolver_DS::set_lookahead(bool enabled) {
+    use_lookahead = enabled;
+}
+
+const vector<string>& DPLLSolver_DS::parameter_names() {
+    static const vector<string> names = {
+        "decay_factor", "conflict_weight", "decay_interval",
+        "learned_clause_limit_percentage", "max_learned_clause_len",
+        "restart_base", "restart_growth", "inprocess_effort", "lookahead", "decompose", "reorder"
+    };
+    return names;
+}
+
+bool DPLLSolver_DS::set_parameter(const string& name, double value) {
+    if (name == "decay_factor") {
+        if (!(value > 0 && value <= 1)) return false;
+        decay_factor = value;
+    } else if (name == "conflict_weight") {
+        if (!(value > 0)) return false;
+        conflict_weight = value;
+    } else if (name == "decay_interval") {
+        if (!(value >= 1)) return false;
+        decay_interval = (int)value;
+    } else if (name == "learned_clause_limit_percentage") {
+        if (!(value >= 0 && value <= 1000)) return false;
+        learned_clause_limit_percentage = (int)value;
+        max_learned_clauses = (int)(num_original_clauses * (learned_clause_limit_percentage / 100.0));
+    } else if (name == "max_learned_clause_len") {
+        if (!(value >= 1 && value < 1e6)) return false;
+        max_learned_clause_len = (int)value + 1;
+    } else if (name == "restart_base") {
+        if (!(value >= 1 && value < 1e9)) return false;
+        restart_base = (int)value;
+        next_restart = conflicts + restart_base;
+    } else if (name == "restart_growth") {
+        if (!(value >= 1 && value <= 100)) return false;
+        restart_growth = value;
+    } else if (name == "inprocess_effort") {
+        if (!(value >= 0 && value <= 1)) return false;
+        inprocess_effort = value;
+    } else if (name == "lookahead") {
+        if (value != 0 && value != 1) return false;
+        use_lookahead = (value == 1);
+    } else if (name == "decompose") {
+        if (value != 0 && value != 1) return false;
+        decompose = (value == 1);
+    } else if (name == "reorder") {
+        if (value != 0 && value != 1) return false;
+        reorder = (value == 1);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double DPLLSolver_DS::get_parameter(const string& name) const {
+    if (name == "decay_factor") return decay_factor;
+    if (name == "conflict_weight") return conflict_weight;
+    if (name == "decay_interval") return decay_interval;
+    if (name == "learned_clause_limit_percentage") return learned_clause_limit_percentage;
+    if (name == "max_learned_clause_len") return max_learned_clause_len - 1;
+    if (name == "restart_base") return restart_base;
+    if (name == "restart_growth") return restart_growth;
+    if (name == "inprocess_effort") return inprocess_effort;
+    if (name == "lookahead") return use_lookahead ? 1 : 0;
+    if (name == "decompose") return decompose ? 1 : 0;
+    if (name == "reorder") return reorder ? 1 : 0;
+    throw invalid_argument("Error: Unknown solver parameter " + name + ".");
+}
+
+vector<pair<string, double>> DPLLSolver_DS::instance_features() const {
+    vector<int> pos(num_vars + 1, 0), neg(num_vars + 1, 0), degree(num_vars + 1, 0), root(num_vars + 1);
+    for (int var = 0; var <= num_vars; var++)
+        root[var] = var;
+    auto find = [&root](int var) {
+        while (root[var] != var)
+            var = root[var] = root[root[var]];
+        return var;
+    };
+    long long literals = 0, positive = 0, horn = 0, binary_edges = 0;
+    long long by_length[4] = {0, 0, 0, 0};          // 1, 2, 3, longer
+    for (int idx = 0; idx < num_original_clauses; idx++) {
+        const auto clause = original_cnf[idx];
+        int clause_positive = 0;
+        for (int lit : clause) {
+            (lit > 0 ? pos : neg)[abs(lit)]++;
+            clause_positive += (lit > 0);
+        }
+        literals += (long long)clause.size();
+        positive += clause_positive;
+        horn += (clause_positive <= 1);
+        by_length[min<size_t>(clause.size(), 4) - 1]++;
+        if (clause.size() == 2) {
+            PackedLiterals pair = clause.packed();
+            int a = (int)(pair.first[0] >> 1), b = (int)(pair.first[1] >> 1);
+            degree[a]++;
+            degree[b]++;
+            binary_edges++;
+            root[find(a)] = find(b);
+        }
+    }
+    double clauses = max(1, num_original_clauses);
+    int occurring = 0, binary_vars = 0, components = 0, max_degree = 0;
+    double balance = 0;
+    for (int var = 1; var <= num_vars; var++) {
+        if (pos[var] + neg[var] > 0) {
+            occurring++;
+            balance += fabs(pos[var] - neg[var]) / (double)(pos[var] + neg[var]);
+        }
+        if (degree[var] > 0) {
+            binary_vars++;
+            max_degree = max(max_degree, degree[var]);
+            components += (find(var) == var);
+        }
+    }
+    double vars = max(1, occurring);
+    double mean_degree = 2.0 * binary_edges / max(1, binary_vars);
+    return {
+        {"log_vars", log10(vars)},
+        {"log_clauses", log10(clauses)},
+        {"ratio", num_original_clauses / vars},
+        {"len1", by_length[0] / clauses},
+        {"len2", by_length[1] / clauses},
+        {"len3", by_length[2] / clauses},
+        {"len_long", by_length[3] / clauses},
+        {"len_mean", literals / clauses},
+        {"positive", positive / (double)max(1LL, literals)},
+        {"polarity_balance", balance / vars},
+        {"horn", horn / clauses},
+        {"binary_vars", binary_vars / vars},
+        {"binary_degree", mean_degree},
+        {"binary_max_degree", max_degree / max(1.0, mean_degree)},
+        {"binary_components", components / (double)max(1, binary_vars)},
+    };
+}
+
+void DPLLSolver_DS::set_limits(long long max_conflicts, double max_seconds, const atomic<bool>* cancel) {
+    conflict_limit = (max_conflicts >= 0 ? conflicts + max_conflicts : -1);
+    has_deadline = (max_seconds > 0);
+    if (has_deadline)
+        deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max_seconds));
+    cancel_flag = cancel;
+}
+
+SolveStatus DPLLSolver_DS::solve_limited() {
+    components_solved = 0;
+    fix_variable_order();
+    SolveStatus status;
+    if (!prepare_root())
+        status = SolveStatus::Unsatisfiable;
+    else if (!(decompose && !core_tracking && snapshot_path.empty() && !trace_out && !trace_in && solve_components(status)))
+        status = search();
+    if (status != SolveStatus::Unknown)
+        trace('E', status == SolveStatus::Satisfiable ? 1 : 2);
+    if (trace_out)
+        trace_out->flush();
+    return status;
+}
+
+void DPLLSolver_DS::record_trace(const string& path) {
+    trace_out.reset(new TraceWriter(path, get_formula_key()));
+}
+
+void DPLLSolver_DS::replay_trace(const string& path) {
+    trace_in.reset(new TraceReader(path));
+    if (!(trace_in->key() == get_formula_key()))
+        throw runtime_error("Error: Trace " + path + " was recorded for a different formula.");
+}
+
+string DPLLSolver_DS::trace_summary() const {
+    ostringstream out;
+    char tag;
+    uint64_t value;
+    if (trace_out)
+        out << "Trace: " << trace_out->events() << " events recorded";
+    if (!replay_divergence.empty())
+        out << (trace_out ? "; r" : "R") << "eplay: left the trace at " << replay_divergence;
+    else if (traced_events > 0 || trace_in)
+        out << (trace_out ? "; r" : "R") << "eplay: followed " << traced_events << " events"
+            << (trace_in && trace_in->peek(tag, value) ? " (trace continues)" : "");
+    return out.str();
+}
+
+SolveStatus DPLLSolver_DS::step(long long max_conflicts, long long max_assignments) {
+    if (step_status != SolveStatus::Unknown)
+        return step_status;
+    if (!stepping) {
+        stepping = true;
+        fix_variable_order();
+        if (!prepare_root())
+            return step_status = SolveStatus::Unsatisfiable;
+    }
+    conflict_limit = (max_conflicts >= 0 ? conflicts + max_conflicts : -1);
+    assignment_limit = (max_assignments >= 0 ? assignment_count + max_assignments : -1);
+    step_status = search();
+    assignment_limit = -1;
+    return step_status;
+}
+
+bool DPLLSolver_DS::enumerate(const vector<int>& projection, function<bool(const vector<int>&, int)> report) {
+    for (int var : projection)
+        declare_variables(abs(var));
+    fix_variable_order();
+    projected.assign(num_vars + 1, projection.empty() ? 1 : 0);
+    projected[0] = 0;
+    for (int var : projection)
+        projected[solver_variable(abs(var))] = 1;
+    model_report = std::move(report);
+    enumerating = true;
+    if (prepare_root()) {
+        reserve_search_buffers();
+        SAT_COUNT_ALLOCATIONS(Search);
+        dpll();
+        backtrack_to(assignments_stack, 0);
+    }
+    restart_pending = false;
+    enumerating = false;
+    model_report = nullptr;
+    return !aborted;
+}
+
+void DPLLSolver_DS::enable_snapshots(const string& path, double interval_seconds) {
+    snapshot_path = path;
+    snapshot_interval = interval_seconds;
+    get_formula_key();
+    last_snapshot = chrono::steady_clock::now();
+}
+
+bool DPLLSolver_DS::save_snapshot(const string& path) {
+    string tmp_path = path + ".tmp";
+    ofstream out(tmp_path, ios::binary | ios::trunc);
+    if (!out)
+        return false;
+    out.write(SNAPSHOT_MAGIC, 8);
+    write_pod(out, SNAPSHOT_VERSION);
+    write_pod(out, (uint32_t)num_vars);
+    write_pod(out, get_formula_key().hi);
+    write_pod(out, get_formula_key().lo);
+    write_pod(out, (uint64_t)conflicts);
+    // Written in input numbering, so that a resume need not renumber the same way.
+    for (int var = 1; var <= num_vars; var++) {
+        int internal = solver_variable(var);
+        write_pod(out, lit_activity[packed_literal(internal)]);
+        write_pod(out, lit_activity[packed_literal(-internal)]);
+        write_pod(out, saved_phase[internal]);
+    }
+    uint32_t count = (uint32_t)(root_trail.size() + (cnf.size() - num_original_clauses));
+    write_pod(out, count);
+    for (int lit : root_trail) {
+        write_pod(out, (uint32_t)1);
+        write_pod(out, (int32_t)input_literal(lit));
+    }
+    for (size_t idx = num_original_clauses; idx < original_cnf.size(); idx++) {
+        write_pod(out, (uint32_t)original_cnf[idx].size());
+        for (int lit : original_cnf[idx])
+            write_pod(out, (int32_t)input_literal(lit));
+    }
+    out.close();
+    if (!out)
+        return false;
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+void DPLLSolver_DS::load_snapshot(const string& path) {
+    if (core_tracking)
+        throw runtime_error("Error: Snapshot clauses have no proofs, so they cannot be used while tracking the core.");
+    ifstream in(path, ios::binary);
+    if (!in)
+        throw runtime_error("Error: Cannot open snapshot file " + path + ".");
+    char magic[8];
+    uint32_t version = 0, snapshot_vars = 0, count = 0;
+    FormulaKey snapshot_key;
+    uint64_t snapshot_conflicts = 0;
+    in.read(magic, 8);
+    read_pod(in, version);
+    read_pod(in, snapshot_vars);
+    read_pod(in, snapshot_key.hi);
+    read_pod(in, snapshot_key.lo);
+    read_pod(in, snapshot_conflicts);
+    if (!in || string(magic, 8) != string(SNAPSHOT_MAGIC, 8) || version != SNAPSHOT_VERSION)
+        throw runtime_error("Error: " + path + " is not a solver snapshot.");
+    if (snapshot_vars != (uint32_t)num_vars || !(snapshot_key == get_formula_key()))
+        throw runtime_error("Error: Snapshot " + path + " was written for a different formula.");
+    for (int var = 1; var <= num_vars; var++) {
+        read_pod(in, lit_activity[packed_literal(var)]);
+        read_pod(in, lit_activity[packed_literal(-var)]);
+        read_pod(in, saved_phase[var]);
+    }
+    read_pod(in, count);
+    vector<unordered_set<int>> learned;
+    for (uint32_t i = 0; i < count && in; i++) {
+        uint32_t length = 0;
+        read_pod(in, length);
+        unordered_set<int> clause;
+        for (uint32_t j = 0; j < length && in; j++) {
+            int32_t lit = 0;
+            read_pod(in, lit);
+            if (lit == 0 || abs(lit) > num_vars)
+                throw runtime_error("Error: Snapshot " + path + " is corrupt.");
+            clause.insert(lit);
+        }
+        learned.push_back(clause);
+    }
+    if (!in)
+        throw runtime_error("Error: Snapshot " + path + " is truncated.");
+    // Snapshot clauses are implied by the formula, so they join as learned clauses
+    // regardless of the learned-clause cap.
+    for (auto& clause : learned) {
+        longest_clause = max(longest_clause, clause.size());
+        cnf.push_back(clause);
+        original_cnf.push_back(clause);
+        clause_info.push_back(ClauseInfo());
+        attach_clause((int)cnf.size() - 1);
+    }
+    learned_clauses_count = (int)cnf.size() - num_original_clauses;
+    conflicts = (long long)snapshot_conflicts;
+    next_restart = conflicts + restart_base;
+    use_saved_phases = true;
+}
+
+int DPLLSolver_DS::solver_variable(int var) const {
+    return solver_var.empty() ? var : solver_var[var];
+}
+
+int DPLLSolver_DS::input_value(int var) const {
+    return value_of(solver_variable(var));
+}
+
+vector<int> DPLLSolver_DS::get_model() const {
+    vector<int> model;
+    for (int var = 1; var <= num_vars; var++) {
+        if (input_value(var) != -1)
+            model.push_back(input_value(var) == 1 ? var : -var);
+    }
+    return model;
+}
+
+void DPLLSolver_DS::print_assignments() {
+    cout << "ASSIGNMENT: ";
+    for (int var = 1; var <= num_vars; var++) {
+        if (input_value(var) != -1) {
+            cout << var << "=" << input_value(var) << " ";
+        }
+    }
+    cout << "\n";
+}
+
+unordered_map<int, int> DPLLSolver_DS::get_assignments() {
+    unordered_map<int, int> assignments;
+    for (int var = 1; var <= num_vars; var++) {
+        if (input_value(var) != -1)
+            assignments[var] = input_value(var);
+    }
+    return assignments;
+}
+
+void DPLLSolver_DS::track_core() {
+    if (input_clauses > 0)
+        throw logic_error("DPLLSolver_DS::track_core() must be called before add_clause().");
+    core_tracking = true;
+}
+
+vector<int> DPLLSolver_DS::unsat_core() const {
+    if (empty_clause_id >= 0)
+        return {empty_clause_id};
+    vector<int> uses(root_uses);
+    uses.insert(uses.end(), episode_uses.begin(), episode_uses.end());
+    return proof_inputs(uses);
+}
+
+vector<pair<vector<int>, vector<int>>> DPLLSolver_DS::derived_clauses() const {
+    vector<pair<vector<int>, vector<int>>> derived;
+    vector<int> root = proof_inputs(root_uses);
+    for (int lit : root_trail)
+        derived.push_back({{lit}, root});
+    for (size_t idx = num_original_clauses; idx < original_cnf.size(); idx++) {
+        vector<int> uses(root_uses);
+        uses.push_back(clause_info[idx].proof_id);
+        derived.push_back({vector<int>(original_cnf[idx].begin(), original_cnf[idx].end()), proof_inputs(uses)});
+    }
+    return derived;
+}
+
+void DPLLSolver_DS::add_derived_clause(const vector<int>& lits, const vector<int>& inputs) {
+    longest_clause = max(longest_clause, lits.size());
+    cnf.push_back(lits);
+    original_cnf.push_back(lits);
+    clause_info.push_back(ClauseInfo(core_tracking ? add_proof_node(inputs.data(), inputs.data() + inputs.size()) : -1));
+    attach_clause((int)cnf.size() - 1);
+    learned_clauses_count++;
+}
+
+SolveStatus DPLLSolver_DS::search() {
+    SAT_PHASE(Search);
+    aborted = false;
+    reserve_search_buffers();
+    SAT_COUNT_ALLOCATIONS(Search);
+    while (true) {
+        auto search_start = chrono::steady_clock::now();
+        reserve_proof_nodes();
+        regrow_occurrence_lists();
+        episode_uses.clear();
+        core_scope = ++core_episodes;
+        bool result = dpll();
+        core_scope = 1;
+        search_seconds += chrono::duration<double>(chrono::steady_clock::now() - search_start).count();
+        if (result) {
+            extend_model();
+            return SolveStatus::Satisfiable;
+        }
+        if (aborted) {
+            backtrack_to(assignments_stack, 0);
+            restart_pending = false;
+            return SolveStatus::Unknown;
+        }
+        if (!restart_pending)
+            return SolveStatus::Unsatisfiable;
+        episode_uses.clear();
+        backtrack_to(assignments_stack, 0);
+        restart_pending = false;
+        resume_decisions.clear();
+        restarts++;
+        next_restart = conflicts + (long long)(restart_base * pow(restart_growth, restarts));
+        if (!inprocess_between_restarts())
+            return SolveStatus::Unsatisfiable;
+    }
+}
+
+bool DPLLSolver_DS::prepare_root() {
+    SAT_PHASE(Preprocess);
+    assignments_stack.clear();
+    aborted = false;
+    // Units seen while loading go first, so the first rebuild already drops what they satisfy.
+    for (size_t i = 0; i < input_units.size() && !root_conflict; i++) {
+        use_proof_id(input_unit_ids[i]);
+        if (!propagate(input_units[i], root_trail))
+            root_conflict = true;
+    }
+    input_units.clear();
+    input_unit_ids.clear();
+    if (root_conflict || !inprocess())
+        return false;
+    // Enumeration counts unassigned variables as free, which group members are not.
+    // At-most-one groups have no proof nodes, so core tracking keeps the clauses.
+    if (!amo_extracted && !enumerating && !core_tracking) {
+        amo_extracted = true;
+        return extract_at_most_one();
+    }
+    return true;
+}
+
+bool DPLLSolver_DS::model_found() {
+    if (!enumerating || completing)
+        return true;
+    report_model();
+    return false;
+}
+
+void DPLLSolver_DS::report_model() {
+    vector<int>& cube = cube_scratch;
+    cube.clear();
+    int free_vars = 0;
+    for (int var = 1; var <= num_vars; var++) {
+        int internal = solver_variable(var);
+        if (!projected[internal])
+            continue;
+        if (value_of(internal) == -1)
+            free_vars++;
+        else
+            cube.push_back(value_of(internal) == 1 ? var : -var);
+    }
+    bool go_on;
+    {
+        SAT_COUNT_ALLOCATIONS(Off);          // The caller's code
+        go_on = model_report(cube, free_vars);
+    }
+    if (!go_on) {
+        aborted = true;
+        restart_pending = true;
+    }
+}
+
+bool DPLLSolver_DS::keeps_all_polarities(int literal) const {
+    return enumerating && !completing && projected[abs(literal)];
+}
+
+bool DPLLSolver_DS::resumes_at(size_t depth) {
+    size_t begin = (depth == 0 ? 0 : resume_decisions[depth - 1].trail_position + 1);
+    size_t end = resume_decisions[depth].trail_position;
+    if (assignments_stack.size() != end)
+        return false;
+    trail_now.assign(assignments_stack.begin() + begin, assignments_stack.end());
+    trail_then.assign(resume_trail.begin() + begin, resume_trail.begin() + end);
+    sort(trail_now.begin(), trail_now.end());
+    sort(trail_then.begin(), trail_then.end());
+    return trail_now == trail_then;
+}
+
+bool DPLLSolver_DS::dpll() {
+    // A step() budget is checked on entry to every node, so that the search stops
+    // between nodes and the next step resumes without repeating a conflict.
+    if ((++limit_check_counter & 255) == 0 ||
+        (stepping && ((conflict_limit >= 0 && conflicts >= conflict_limit) ||
+                      (assignment_limit >= 0 && assignment_count >= assignment_limit))))
+        check_limits();
+    if (restart_pending)
+        return false;
+    decision_count++;
+    if (decision_count % decay_interval == 0) {
+        decision_count = 0;
+        decay_counters();
+    }
+
+    // Unit Clause Propagation (the scan for unit clauses counts as propagation)
+    {
+        SAT_PHASE(Propagate);
+        if (!force_at_most_one()) {
+            note_conflict();
+            return false;
+        }
+        vector<int>& unit_clauses = unit_scratch;
+        unit_clauses.clear();
+        for (int idx : unsatisfied_clauses) {
+            if (cnf[idx].size() == 1)
+                unit_clauses.push_back(idx);
+        }
+        while (!unit_clauses.empty()) {
+            int idx = unit_clauses.back();
+            unit_clauses.pop_back();
+            if (cnf[idx].empty()) continue;
+            int unit = *(cnf[idx].begin());
+            clause_info[idx].activity += 1.0;
+            use_clause(idx);
+            if (!assign(unit)) {
+                if (last_assignment_status.conflict && last_assignment_status.reason.size() < (size_t)max_learned_clause_len)
+                    add_learned_clause(last_assignment_status);
+                unassign(unit);
+                note_conflict();
+                return false;
+            }
+            assignments_stack.push_back(unit);
+            unsatisfied_clauses.erase(idx);
+            if (!force_at_most_one()) {
+                note_conflict();
+                return false;
+            }
+            // Recompute unit clauses after propagation.
+            unit_clauses.clear();
+            for (int j : unsatisfied_clauses) {
+                if (cnf[j].size() == 1)
+                    unit_clauses.push_back(j);
+            }
+        }
+    }
+    if (unsatisfied_clauses.empty())
+        return model_found();
+
+    // Pure Literal Elimination
+    while (true) {
+        vector<int>& pure_literals = find_pure_literals();
+        pure_literals.erase(remove_if(pure_literals.begin(), pure_literals.end(), [this](int lit) {
+            return keeps_all_polarities(lit) || !amo_occurrences[packed_literal(lit)].empty();
+        }), pure_literals.end());
+        if (pure_literals.empty())
+            break;
+        for (int lit : pure_literals) {
+            if (!assign(lit)) {
+                unassign(lit);
+                return false;
+            }
+            assignments_stack.push_back(lit);
+        }
+    }
+    if (unsatisfied_clauses.empty())
+        return model_found();
+
+    // Branching: choose a literal by lookahead or based on VSIDS frequency.
+    bool project_first = enumerating && !completing && projection_is_partial();
+    int branch_lit = 0;
+    bool replayed = false;
+    if (trace_in) {
+        if (!replay_decision(branch_lit, replayed))
+            return false;
+        if (unsatisfied_clauses.empty())
+            return model_found();
+    }
+    if (!replayed && use_lookahead && !project_first) {
+        if (!lookahead(branch_lit))
+            return false;
+        if (unsatisfied_clauses.empty())
+            return model_found();
+    }
+    if (branch_lit == 0 && !replayed)
+        branch_lit = vsids_frequent_literal(project_first);
+    if (branch_lit == 0 && project_first) {
+        // The projection is decided: find one extension, report the projected cube
+        // once and backtrack over the rest.
+        completing = true;
+        size_t mark = assignments_stack.size();
+        bool extended = dpll();
+        completing = false;
+        if (extended && !aborted)
+            report_model();
+        while (assignments_stack.size() > mark) {
+            unassign(assignments_stack.back());
+            assignments_stack.pop_back();
+        }
+        return false;
+    }
+    if (branch_lit == 0) {
+        if (trace_out)
+            trace_out->event('D', 0);
+        // Every clause left is falsified (its last literal fell to a decision).
+        if (!unsatisfied_clauses.empty())
+            use_clause(*unsatisfied_clauses.begin());
+        return unsatisfied_clauses.empty() && model_found();
+    }
+    // After a warm start, follow the polarity the interrupted run last used.
+    int phase = saved_phase[abs(branch_lit)];
+    if (use_saved_phases && phase != -1 && !replayed)
+        branch_lit = (phase == 1 ? abs(branch_lit) : -abs(branch_lit));
+    // Resuming a step: re-enter the decision the interrupted search had open here.
+    bool refuted_first = false;
+    size_t depth = open_decisions.size();
+    if (depth < resume_decisions.size() && resumes_at(depth)) {
+        const OpenDecision& open = resume_decisions[depth];
+        branch_lit = (open.second_branch ? -open.literal : open.literal);
+        refuted_first = open.second_branch;
+    } else {
+        resume_decisions.clear();
+    }
+    if (trace_out)
+        trace_out->event('D', zigzag(branch_lit));
+
+    // Try assigning branch_lit and then its negation with backtracking.
+    for (int val : {branch_lit, -branch_lit}) {
+        if (refuted_first) {
+            refuted_first = false;
+            continue;
+        }
+        if (assign(val)) {
+            assignments_stack.push_back(val);
+            open_decisions.push_back({assignments_stack.size() - 1, val, val != branch_lit});
+            size_t last_stack_length = assignments_stack.size();
+            bool satisfied = dpll();
+            open_decisions.pop_back();
+            if (satisfied)
+                return true;
+            if (!aborted)
+                resume_decisions.clear();
+            // Backtrack: unassign all assignments added in the recursive call.
+            while (assignments_stack.size() >= last_stack_length) {
+                int popped = assignments_stack.back();
+                assignments_stack.pop_back();
+                unassign(popped);
+            }
+            unassign(val);
+            if (restart_pending)
+                return false;
+        } else {
+            resume_decisions.clear();
+            note_conflict();
+            if (last_assignment_status.conflict && last_assignment_status.reason.size() < (size_t)max_learned_clause_len) {
+                add_learned_clause(last_assignment_status);
+                unassign(val);
+                // Enumeration must still visit the other branch.
+                if (enumerating && !completing)
+                    continue;
+                return false;
+            }
+            unassign(val);
+        }
+    }
+    return false;
+}
+
+vector<int>& DPLLSolver_DS::find_pure_literals() {
+    SAT_PHASE(Decide);
+    for (int idx : unsatisfied_clauses) {
+        for (int lit : cnf[idx])
+            tally(lit, 1.0);
+    }
+    pure_scratch.clear();
+    for (int lit : tallied_literals) {
+        if (literal_tally[packed_literal(-lit)] == 0 && value_of(lit) == -1)
+            pure_scratch.push_back(lit);
+    }
+    clear_tally();
+    return pure_scratch;
+}
+
+void DPLLSolver_DS::tally(int literal, double weight) {
+    double& entry = literal_tally[packed_literal(literal)];
+    if (entry == 0)
+        tallied_literals.push_back(literal);
+    entry += weight;
+}
+
+void DPLLSolver_DS::clear_tally() {
+    for (int lit : tallied_literals)
+        literal_tally[packed_literal(lit)] = 0;
+    tallied_literals.clear();
+}
+
+//--------------------------------------------------------------
+// Lookahead decisions
+//--------------------------------------------------------------
+
+bool DPLLSolver_DS::lookahead(int& branch_lit) {
+    SAT_PHASE(Decide);
+    branch_lit = 0;
+    const vector<int>& candidates = lookahead_candidates();
+    vector<int>& trail = probe_trail;
+    trail.clear();
+    double best = -1.0;
+    for (int var : candidates) {
+        if (value_of(var) != -1)
+            continue;               // Fixed by an earlier failed literal.
+        double score[2];
+        bool failed[2];
+        for (int side = 0; side < 2; side++) {
+            int lit = (side == 0 ? var : -var);
+            if (trace_out)
+                trace_out->event('P', zigzag(lit));
+            failed[side] = !propagate(lit, trail);
+            score[side] = (failed[side] ? 0.0 : reduction_score(trail));
+            if (!failed[side] && score[side] > double_lookahead_threshold())
+                failed[side] = !double_lookahead(candidates, var, trail);
+            backtrack_to(trail, 0);
+            if (trace_out)
+                trace_out->event('U');
+            if (failed[side])
+                break;
+        }
+        if (failed[0] || failed[1]) {
+            int forced = (failed[0] ? -var : var);
+            if (trace_out)
+                trace_out->event('F', zigzag(forced));
+            if (!propagate(forced, assignments_stack))
+                return false;
+            if (unsatisfied_clauses.empty())
+                return true;
+            continue;
+        }
+        // march's mix of the two sides: favour variables that shrink both.
+        double combined = 1024.0 * score[0] * score[1] + score[0] + score[1];
+        if (combined > best) {
+            best = combined;
+            // Take the side that shrinks less first; it is more likely to be satisfiable.
+            branch_lit = (score[0] <= score[1] ? var : -var);
+        }
+    }
+    if (branch_lit != 0 && value_of(branch_lit) != -1)
+        branch_lit = 0;
+    return true;
+}
+
+const vector<int>& DPLLSolver_DS::lookahead_candidates() {
+    for (int idx : unsatisfied_clauses) {
+        int unassigned = 0;
+        for (unsigned q : cnf[idx].packed())
+            unassigned += (lit_value[q] == -1);
+        double w = (unassigned <= 2 ? 5.0 : unassigned == 3 ? 1.0 : 0.2);
+        for (unsigned q : cnf[idx].packed()) {
+            if (lit_value[q] == -1)
+                tally((int)(q >> 1), w);
+        }
+    }
+    vector<pair<double, int>>& ranked = ranked_scratch;
+    ranked.clear();
+    for (int var : tallied_literals)
+        ranked.push_back({literal_tally[packed_literal(var)], var});
+    clear_tally();
+    size_t keep = min(ranked.size(), max<size_t>(8, min<size_t>(40, ranked.size() / 10)));
+    partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end(), greater<pair<double, int>>());
+    lookahead_scratch.clear();
+    for (size_t i = 0; i < keep; i++)
+        lookahead_scratch.push_back(ranked[i].second);
+    return lookahead_scratch;
+}
+
+double DPLLSolver_DS::reduction_score(const vector<int>& trail) {
+    double score = 0.0;
+    for (int lit : trail) {
+        for (int idx : occurrences[packed_literal(lit) ^ 1]) {
+            if (!unsatisfied_clauses.count(idx))
+                continue;
+            int unassigned = 0;
+            for (unsigned q : cnf[idx].packed())
+                unassigned += (lit_value[q] == -1);
+            score +=  (unassigned == 2 ? 1.0 : unassigned == 3 ? 0.2 : 0.05);
+        }
+    }
+    return score;
+}
+
+double DPLLSolver_DS::double_lookahead_threshold() const {
+    return 0.1 * unsatisfied_clauses.size() + 5.0;
+}
+
+bool DPLLSolver_DS::double_lookahead(const vector<int>& candidates, int var, vector<int>& trail) {
+    size_t mark = trail.size();
+    int checked = 0;
+    for (int other : candidates) {
+        if (other == var || value_of(other) != -1)
+            continue;
+        if (++checked > 8)
+            break;
+        if (trace_out)
+            trace_out->event('P', zigzag(other));
+        bool pos_ok = propagate(other, trail);
+        backtrack_to(trail, mark);
+        if (trace_out)
+            trace_out->event('U');
+        if (pos_ok)
+            continue;
+        if (trace_out)
+            trace_out->event('P', zigzag(-other));
+        bool neg_ok = propagate(-other, trail);
+        backtrack_to(trail, mark);
+        if (trace_out)
+            trace_out->event('U');
+        if (!neg_ok)
+            return false;
+    }
+    return true;
+}
+
+bool DPLLSolver_DS::projection_is_partial() const {
+    return find(projected.begin() + 1, projected.end(), 0) != projected.end();
+}
+
+int DPLLSolver_DS::vsids_frequent_literal(bool projected_only) {
+    SAT_PHASE(Decide);
+    if (unsatisfied_clauses.empty())
+        return 0;
+    for (int idx : unsatisfied_clauses) {
+        for (unsigned p : cnf[idx].packed()) {
+            if (lit_value[p] == -1 && (!projected_only || projected[p >> 1]))
+                tally(unpacked_literal(p), 1.0 + lit_activity[p]);
+        }
+    }
+    int best_literal = 0;
+    double best_count = -1;
+    for (int lit : tallied_literals) {
+        if (literal_tally[packed_literal(lit)] > best_count) {
+            best_count = literal_tally[packed_literal(lit)];
+            best_literal = lit;
+        }
+    }
+    clear_tally();
+    return best_literal;
+}
+
+bool DPLLSolver_DS::assign(int literal) {
+    SAT_PHASE(Propagate);
+    unsigned p = packed_literal(literal);
+    // Reset conflict status.
+    last_assignment_status.conflict = false;
+    last_assignment_status.reason.clear();
+
+    // If already assigned, check for consistency.
+    if (lit_value[p] != -1)
+        return lit_value[p] == 1;
+    // Set the assignment.
+    lit_value[p] = 1;
+    lit_value[p ^ 1] = 0;
+    assignment_count++;
+    if (!amo_occurrences[p].empty())
+        amo_queue.push_back(literal);
+
+    // The conflict clause is gathered in the reason buffer itself, which keeps its
+    // capacity from one assignment to the next.
+    int count = 0;
+    int reason_clause = -1;
+    vector<int>& conflict_clause = last_assignment_status.reason;
+
+    // Process clauses where the literal appears in the satisfied polarity.
+    for (int idx : occurrences[p]) {
+        if (unsatisfied_clauses.count(idx)) {
+            bool all_assigned_false = true;
+            for (unsigned q : original_cnf[idx].packed()) {
+                if (q == p) continue;
+                if (lit_value[q] != 0) { all_assigned_false = false; break; }
+            }
+            if (all_assigned_false && count == 0) {
+                count = 1;
+                reason_clause = idx;
+                for (unsigned q : original_cnf[idx].packed()) {
+                    if (lit_value[q] == 0)
+                        conflict_clause.push_back(unpacked_literal(q));
+                }
+            }
+            unsatisfied_clauses.erase(idx);
+        }
+    }
+    // Process clauses where the literal appears in the opposite polarity.
+    for (int idx : occurrences[p ^ 1]) {
+        if (unsatisfied_clauses.count(idx)) {
+            if (cnf[idx].size() == 1 && count == 1) {
+                clause_info[idx].activity += 1.0;
+                size_t first_clause = conflict_clause.size();
+                for (unsigned q : original_cnf[idx].packed()) {
+                    int lit = unpacked_literal(q);
+                    if (q != (p ^ 1) && find(conflict_clause.begin(), conflict_clause.begin() + first_clause, lit) ==
+                                            conflict_clause.begin() + first_clause)
+                        conflict_clause.push_back(lit);
+                }
+                last_assignment_status.conflict = true;
+                last_assignment_status.clauses[0] = reason_clause;
+                last_assignment_status.clauses[1] = idx;
+                use_clause(reason_clause);
+                use_clause(idx);
+                lit_value[p] = lit_value[p ^ 1] = -1;  // revert assignment
+                return false;
+            }
+            // Remove the literal that is now false.
+            cnf[idx].erase(p ^ 1);
+        }
+    }
+    conflict_clause.clear();
+    return true;
+}
+
+void DPLLSolver_DS::unassign(int literal) {
+    SAT_PHASE(Propagate);
+    unsigned p = packed_literal(literal);
+    unsigned positive = p & ~1u;
+    if (lit_value[positive] != -1)
+        saved_phase[p >> 1] = lit_value[positive];
+    lit_value[p] = lit_value[p ^ 1] = -1;
+    for (int idx : occurrences[p ^ 1]) {
+        cnf[idx].insert(p ^ 1);
+    }
+    for (int idx : occurrences[p]) {
+        if (!is_clause_satisfied(idx))
+            unsatisfied_clauses.insert(idx);
+    }
+}
+
+bool DPLLSolver_DS::is_clause_satisfied(int clause_index) {
+    for (unsigned q : cnf[clause_index].packed()) {
+        if (lit_value[q] == 1)
+            return true;
+    }
+    return false;
+}
+
+void DPLLSolver_DS::use_clause(int idx) {
+    if (core_tracking)
+        use_proof_id(clause_info[idx].proof_id);
+}
+
+void DPLLSolver_DS::use_proof_id(int id) {
+    if (!core_tracking || core_mark[id] == 1 || core_mark[id] == core_scope)
+        return;
+    core_mark[id] = core_scope;
+    (core_scope == 1 ? root_uses : episode_uses).push_back(id);
+}
+
+int DPLLSolver_DS::add_proof_node(const int* first, const int* last) {
+    proof_parents.insert(proof_parents.end(), first, last);
+    proof_start.push_back(proof_parents.size());
+    core_mark.push_back(0);
+    return input_clauses + (int)proof_start.size() - 2;
+}
+
+vector<int> DPLLSolver_DS::proof_inputs(const vector<int>& uses) const {
+    vector<char> seen(core_mark.size(), 0);
+    vector<int> pending(uses), inputs;
+    while (!pending.empty()) {
+        int id = pending.back();
+        pending.pop_back();
+        if (seen[id])
+            continue;
+        seen[id] = 1;
+        if (id < input_clauses) {
+            inputs.push_back(id);
+            continue;
+        }
+        size_t node = id - input_clauses;
+        pending.insert(pending.end(), proof_parents.begin() + proof_start[node], proof_parents.begin() + proof_start[node + 1]);
+    }
+    sort(inputs.begin(), inputs.end());
+    return inputs;
+}
+
+void DPLLSolver_DS::add_learned_clause(const AssignmentStatus& conflict) {
+    SAT_PHASE(Analyze);
+    const vector<int>& learned_clause = conflict.reason;
+    if (learned_clause.empty())
+        return;
+    if (learned_clauses_count >= max_learned_clauses)
+        return;
+    // A learned clause goes into the headroom reserve_search_buffers() left in the
+    // occurrence lists; a full list is grown at the next restart.
+    for (int lit : learned_clause) {
+        const vector<int>& list = occurrences[packed_literal(lit)];
+        if (list.size() == list.capacity()) {
+            dropped_learned_clauses++;
+            occurrences_full = true;
+            return;
+        }
+    }
+    // Its false literals are not live, as if removed by assign().
+    original_cnf.push_back(learned_clause);
+    cnf.push_back(learned_clause);
+    for (int lit : learned_clause) {
+        if (value_of(lit) == 0)
+            cnf[cnf.size() - 1].erase(packed_literal(lit));
+    }
+    int parents[2] = {-1, -1};
+    if (core_tracking) {
+        parents[0] = clause_info[conflict.clauses[0]].proof_id;
+        parents[1] = clause_info[conflict.clauses[1]].proof_id;
+    }
+    clause_info.push_back(ClauseInfo(core_tracking ? add_proof_node(parents, parents + 2) : -1));
+    int learned_clause_index = cnf.size() - 1;
+    trace('L', learned_clause_index);
+    unsatisfied_clauses.insert(learned_clause_index);
+    // Update variable clause lists.
+    for (int lit : learned_clause)
+        occurrences[packed_literal(lit)].push_back(learned_clause_index);
+    learned_clauses_count++;
+    boost_conflict_literals(learned_clause);
+}
+
+//--------------------------------------------------------------
+// At-most-one constraints
+//--------------------------------------------------------------
+
+bool DPLLSolver_DS::extract_at_most_one() {
+    auto edge_key = [](unsigned a, unsigned b) { return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a; };
+    unordered_map<uint64_t, int> edge_clause;    // Uncovered edge -> its clause
+    vector<vector<int>> neighbours(2 * (num_vars + 1));
+    for (int idx = 0; idx < num_original_clauses; idx++) {
+        const ClauseArena::Clause clause = original_cnf[idx];
+        if (clause.size() != 2)
+            continue;
+        auto it = clause.begin();
+        int a = -*it++;
+        int b = -*it;
+        if (edge_clause.emplace(edge_key(packed_literal(a), packed_literal(b)), idx).second) {
+            neighbours[packed_literal(a)].push_back(b);
+            neighbours[packed_literal(b)].push_back(a);
+        }
+    }
+    if (edge_clause.empty())
+        return true;
+
+    vector<int> seeds;
+    for (int var = 1; var <= num_vars; var++) {
+        for (int lit : {var, -var}) {
+            if (neighbours[packed_literal(lit)].size() >= 2)
+                seeds.push_back(lit);
+        }
+    }
+    auto degree = [&neighbours](int lit) { return neighbours[packed_literal(lit)].size(); };
+    stable_sort(seeds.begin(), seeds.end(), [&degree](int a, int b) { return degree(a) > degree(b); });
+
+    vector<int8_t> member_sign(num_vars + 1, 0);
+    vector<char> drop(original_cnf.size(), 0);
+    auto compatible = [&member_sign](int lit) { return member_sign[abs(lit)] == 0 || member_sign[abs(lit)] == (lit > 0 ? 1 : -1); };
+    auto uncovered = [&](int a, int b) {
+        auto it = edge_clause.find(edge_key(packed_literal(a), packed_literal(b)));
+        return it != edge_clause.end() && it->second >= 0;
+    };
+    vector<int> candidates, clique, links, order;
+    for (int seed : seeds) {
+        if (!compatible(seed))
+            continue;
+        candidates.clear();
+        for (int other : neighbours[packed_literal(seed)]) {
+            if (compatible(other) && uncovered(seed, other))
+                candidates.push_back(other);
+        }
+        if (candidates.size() < 2)
+            continue;
+        stable_sort(candidates.begin(), candidates.end(), [&degree](int a, int b) { return degree(a) > degree(b); });
+        // Bound the quadratic tests on dense graphs, then try first the candidates
+        // linked to most of the others: they are the likeliest to share a clique.
+        if (candidates.size() > 64)
+            candidates.resize(64);
+        links.assign(candidates.size(), 0);
+        for (size_t i = 0; i < candidates.size(); i++) {
+            for (size_t j = i + 1; j < candidates.size(); j++) {
+                if (uncovered(candidates[i], candidates[j])) {
+                    links[i]++;
+                    links[j]++;
+                }
+            }
+        }
+        order.resize(candidates.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = (int)i;
+        stable_sort(order.begin(), order.end(), [&links](int a, int b) { return links[a] > links[b]; });
+        clique.assign(1, seed);
+        for (int i : order) {
+            int candidate = candidates[i];
+            if (all_of(clique.begin(), clique.end(), [&](int member) { return uncovered(member, candidate); }))
+                clique.push_back(candidate);
+        }
+        if (clique.size() < 3)
+            continue;
+        for (size_t i = 0; i < clique.size(); i++) {
+            member_sign[abs(clique[i])] = (clique[i] > 0 ? 1 : -1);
+            for (size_t j = i + 1; j < clique.size(); j++) {
+                int& idx = edge_clause[edge_key(packed_literal(clique[i]), packed_literal(clique[j]))];
+                drop[idx] = 1;
+                idx = -1;
+            }
+        }
+        for (int member : clique)
+            amo_occurrences[packed_literal(member)].push_back((int)amo_groups.size());
+        amo_groups.push_back(clique);
+    }
+    return amo_groups.empty() || simplify_root(drop);
+}
+
+bool DPLLSolver_DS::in_at_most_one(int var) const {
+    return !amo_occurrences[packed_literal(var)].empty() || !amo_occurrences[packed_literal(-var)].empty();
+}
+
+bool DPLLSolver_DS::force_at_most_one() {
+    SAT_PHASE(Propagate);
+    while (!amo_queue.empty()) {
+        int lit = amo_queue.back();
+        amo_queue.pop_back();
+        if (value_of(lit) != 1)
+            continue;
+        for (int group : amo_occurrences[packed_literal(lit)]) {
+            for (int member : amo_groups[group]) {
+                if (member != lit && !propagate(-member, assignments_stack)) {
+                    amo_queue.clear();
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+// Root-level inprocessing: failed literals and equivalent literals
+//--------------------------------------------------------------
+
+bool DPLLSolver_DS::inprocess() {
+    if (!simplify_root())
+        return false;
+    for (int round = 0; round < 3; round++) {
+        size_t fixed_before = root_trail.size();
+        size_t eliminated_before = eliminated.size();
+        // Substitution would leave eliminated variables looking free to the enumeration.
+        // Core tracking skips both: their derivations have no proof nodes.
+        if ((!enumerating && !core_tracking && !substitute_equivalent_literals()) ||
+            (!core_tracking && !probe_failed_literals()) || !simplify_root())
+            return false;
+        if (root_trail.size() == fixed_before && eliminated.size() == eliminated_before)
+            break;
+    }
+    return true;
+}
+
+bool DPLLSolver_DS::simplify_root(const vector<char>& drop) {
+    bool first_pass = true;
+    while (!root_conflict) {
+        original_cnf.compact([&](size_t i, vector<int>& kept) {
+            const ClauseArena::Clause clause = original_cnf[i];
+            if (root_conflict) {
+                kept.assign(clause.begin(), clause.end());
+                return true;
+            }
+            if (first_pass && i < drop.size() && drop[i])
+                return false;
+            for (int lit : clause) {
+                int value = value_of(lit);
+                if (value == -1)
+                    kept.push_back(lit);
+                else if (value == 1)
+                    return false;
+            }
+            if (kept.empty()) {
+                use_clause(i);
+                root_conflict = true;
+            }
+            return !kept.empty();
+        }, compact_source, compact_kept);
+        reload_clauses(compact_source);
+        if (root_conflict)
+            break;
+        first_pass = false;
+
+        size_t fixed_before = root_trail.size();
+        for (int idx = 0; idx < (int)cnf.size() && !root_conflict; idx++) {
+            if (cnf[idx].size() == 1 && unsatisfied_clauses.count(idx)) {
+                use_clause(idx);
+                root_conflict = !propagate(*cnf[idx].begin(), root_trail);
+            }
+        }
+        if (root_trail.size() == fixed_before)
+            break;
+    }
+    return !root_conflict;
+}
+
+void DPLLSolver_DS::reload_clauses(const vector<int>& source) {
+    vector<ClauseInfo>& info = info_scratch;
+    info.clear();
+    int original_count = 0;
+    for (size_t i = 0; i < source.size(); i++) {
+        info.push_back(clause_info[source[i]]);
+        if (source[i] < num_original_clauses)
+            original_count++;
+    }
+    cnf.clear();
+    cnf.reserve(original_cnf.size(), original_cnf.used_literals());
+    for (size_t i = 0; i < original_cnf.size(); i++)
+        cnf.emplace_back(original_cnf[i].begin(), original_cnf[i].end());
+    clause_info.swap(info);
+    num_original_clauses = original_count;
+    learned_clauses_count = (int)cnf.size() - num_original_clauses;
+    unsatisfied_clauses.clear();
+    for (auto& list : occurrences)
+        list.clear();
+    for (int i = 0; i < (int)cnf.size(); i++) {
+        unsatisfied_clauses.insert(i);
+        for (unsigned q : original_cnf[i].packed())
+            occurrences[q].push_back(i);
+    }
+}
+
+bool DPLLSolver_DS::propagate(int literal, vector<int>& trail) {
+    SAT_PHASE(Propagate);
+    size_t head = trail.size();
+    if (!enqueue(literal, trail))
+        return false;
+    while (head < trail.size()) {
+        int lit = trail[head++];
+        for (int group : amo_occurrences[packed_literal(lit)]) {
+            for (int member : amo_groups[group]) {
+                if (member != lit && !enqueue(-member, trail))
+                    return false;
+            }
+        }
+        for (int idx : occurrences[packed_literal(lit) ^ 1]) {
+            propagation_visits++;
+            if (!unsatisfied_clauses.count(idx))
+                continue;
+            // cnf[idx] may still hold literals falsified while the clause was satisfied,
+            // so count the literals that are actually unassigned.
+            int unassigned = 0;
+            unsigned unit = 0;
+            bool satisfied = false;
+            for (unsigned q : cnf[idx].packed()) {
+                int value = lit_value[q];
+                if (value == -1) {
+                    unit = q;
+                    if (++unassigned > 1)
+                        break;
+                } else if (value == 1) {
+                    satisfied = true;
+                    break;
+                }
+            }
+            if (satisfied || unassigned > 1)
+                continue;
+            use_clause(idx);
+            if (unassigned == 0 || !enqueue(unpacked_literal(unit), trail))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool DPLLSolver_DS::enqueue(int literal, vector<int>& trail) {
+    int value = value_of(literal);
+    if (value != -1)
+        return value == 1;
+    bool ok = assign(literal);
+    trail.push_back(literal);
+    return ok;
+}
+
+void DPLLSolver_DS::backtrack_to(vector<int>& trail, size_t size) {
+    SAT_PHASE(Propagate);
+    while (trail.size() > size) {
+        unassign(trail.back());
+        trail.pop_back();
+    }
+    while (!amo_queue.empty() && value_of(amo_queue.back()) != 1)
+        amo_queue.pop_back();
+}
+
+bool DPLLSolver_DS::probe_failed_literals() {
+    vector<int>& trail = probe_trail;
+    vector<int>& stamp = probe_stamp;
+    vector<int>& necessary = necessary_scratch;
+    trail.clear();
+    stamp.assign(2 * (num_vars + 1), 0);
+    int probe_id = 0;
+    long long visits_at_start = propagation_visits;
+    for (int var = 1; var <= num_vars && !root_conflict; var++) {
+        if (propagation_visits - visits_at_start > probe_budget)
+            break;
+        if (value_of(var) != -1)
+            continue;
+        if (occurrences[packed_literal(var)].empty() && occurrences[packed_literal(-var)].empty())
+            continue;
+
+        bool pos_ok = propagate(var, trail);
+        probe_id++;
+        for (size_t i = 1; i < trail.size() && pos_ok; i++)
+            stamp[packed_literal(trail[i])] = probe_id;
+        backtrack_to(trail, 0);
+
+        bool neg_ok = propagate(-var, trail);
+        necessary.clear();
+        for (size_t i = 1; i < trail.size() && pos_ok && neg_ok; i++) {
+            if (stamp[packed_literal(trail[i])] == probe_id)
+                necessary.push_back(trail[i]);
+        }
+        backtrack_to(trail, 0);
+
+        if (!pos_ok && !neg_ok)
+            root_conflict = true;
+        else if (!pos_ok)
+            root_conflict = !propagate(-var, root_trail);
+        else if (!neg_ok)
+            root_conflict = !propagate(var, root_trail);
+        for (int lit : necessary) {
+            if (root_conflict)
+                break;
+            root_conflict = !propagate(lit, root_trail);
+        }
+    }
+    return !root_conflict;
+}
+
+bool DPLLSolver_DS::substitute_equivalent_literals() {
+    int nodes = 2 * (num_vars + 1);
+    // The implication graph in compressed rows: the edges of node p are
+    // implication_edges[implication_start[p], implication_start[p + 1]).
+    vector<int>& start = implication_start;
+    vector<int>& edges = implication_edges;
+    start.assign(nodes + 1, 0);
+    for (int idx : unsatisfied_clauses) {
+        if (cnf[idx].size() != 2)
+            continue;
+        auto it = cnf[idx].begin();
+        int a = *it++;
+        int b = *it;
+        start[packed_literal(-a) + 1]++;
+        start[packed_literal(-b) + 1]++;
+    }
+    for (int node = 0; node < nodes; node++)
+        start[node + 1] += start[node];
+    edges.resize(start[nodes]);
+    vector<int>& fill = tarjan_lowlink;     // Next free edge per node, until Tarjan runs
+    fill.assign(start.begin(), start.end() - 1);
+    for (int idx : unsatisfied_clauses) {
+        if (cnf[idx].size() != 2)
+            continue;
+        auto it = cnf[idx].begin();
+        int a = *it++;
+        int b = *it;
+        edges[fill[packed_literal(-a)]++] = b;
+        edges[fill[packed_literal(-b)]++] = a;
+    }
+
+    // Iterative Tarjan; component[node] holds the representative literal.
+    vector<int>& index = tarjan_index;
+    vector<int>& lowlink = tarjan_lowlink;
+    vector<int>& component = scc_component;
+    vector<char>& on_stack = scc_on_stack;
+    vector<int>& scc_stack = scc_scratch;
+    vector<pair<int, size_t>>& call_stack = tarjan_calls;
+    index.assign(nodes, -1);
+    lowlink.assign(nodes, 0);
+    component.assign(nodes, 0);
+    on_stack.assign(nodes, 0);
+    scc_stack.clear();
+    call_stack.clear();
+    int next_index = 0;
+    for (int var = 1; var <= num_vars; var++) {
+        for (int root : {var, -var}) {
+            int root_node = packed_literal(root);
+            if (index[root_node] != -1 || start[root_node] == start[root_node + 1])
+                continue;
+            call_stack.push_back({root, (size_t)start[root_node]});
+            index[root_node] = lowlink[root_node] = next_index++;
+            scc_stack.push_back(root);
+            on_stack[root_node] = true;
+            while (!call_stack.empty()) {
+                int lit = call_stack.back().first;
+                int node = packed_literal(lit);
+                size_t& edge = call_stack.back().second;
+                if (edge < (size_t)start[node + 1]) {
+                    int next = edges[edge++];
+                    int next_node = packed_literal(next);
+                    if (index[next_node] == -1) {
+                        index[next_node] = lowlink[next_node] = next_index++;
+                        scc_stack.push_back(next);
+                        on_stack[next_node] = true;
+                        call_stack.push_back({next, (size_t)start[next_node]});
+                    } else if (on_stack[next_node]) {
+                        lowlink[node] = min(lowlink[node], index[next_node]);
+                    }
+                    continue;
+                }
+                call_stack.pop_back();
+                if (!call_stack.empty()) {
+                    int parent = packed_literal(call_stack.back().first);
+                    lowlink[parent] = min(lowlink[parent], lowlink[node]);
+                }
+                if (lowlink[node] != index[node])
+                    continue;
+                // Pop the component and choose the literal with the smallest variable.
+                size_t start = scc_stack.size();
+                int representative = lit;
+                do {
+                    start--;
+                    if (abs(scc_stack[start]) < abs(representative))
+                        representative = scc_stack[start];
+                } while (scc_stack[start] != lit);
+                for (size_t i = start; i < scc_stack.size(); i++) {
+                    on_stack[packed_literal(scc_stack[i])] = false;
+                    component[packed_literal(scc_stack[i])] = representative;
+                }
+                scc_stack.resize(start);
+            }
+        }
+    }
+
+    // A component holding both x and -x makes the formula unsatisfiable.
+    vector<int>& substitute = substitute_scratch;
+    substitute.assign(num_vars + 1, 0);
+    bool changed = false;
+    for (int var = 1; var <= num_vars; var++) {
+        int representative = component[packed_literal(var)];
+        if (representative == 0)
+            continue;
+        if (representative == -component[packed_literal(-var)] && abs(representative) == var)
+            continue;
+        if (component[packed_literal(-var)] == representative) {
+            root_conflict = true;
+            return false;
+        }
+        // Group members keep their variable: groups are not rewritten.
+        if (abs(representative) != var && !in_at_most_one(var)) {
+            substitute[var] = representative;
+            eliminated.push_back({var, representative});
+            changed = true;
+        }
+    }
+    if (!changed)
+        return true;
+
+    original_cnf.compact([&](size_t i, vector<int>& kept) {
+        for (int lit : original_cnf[i]) {
+            int var = abs(lit);
+            int mapped = (substitute[var] == 0 ? lit : (lit > 0 ? substitute[var] : -substitute[var]));
+            if (find(kept.begin(), kept.end(), -mapped) != kept.end())
+                return false;   // Tautology
+            if (find(kept.begin(), kept.end(), mapped) == kept.end())
+                kept.push_back(mapped);
+        }
+        return true;
+    }, compact_source, compact_kept);
+    reload_clauses(compact_source);
+    return simplify_root();
+}
+
+void DPLLSolver_DS::extend_model() {
+    // A variable is a member with one polarity only, so this cannot violate a group.
+    for (const auto& group : amo_groups) {
+        for (int member : group) {
+            unsigned p = packed_literal(member);
+            if (lit_value[p] == -1) {
+                lit_value[p] = 0;
+                lit_value[p ^ 1] = 1;
+            }
+        }
+    }
+    for (auto it = eliminated.rbegin(); it != eliminated.rend(); ++it) {
+        int var = it->first;
+        int representative = it->second;
+        unsigned rep = packed_literal(representative);
+        if (lit_value[rep] == -1) {
+            lit_value[rep] = 1;
+            lit_value[rep ^ 1] = 0;
+        }
+        lit_value[packed_literal(var)] = lit_value[rep];
+        lit_value[packed_literal(-var)] = lit_value[rep ^ 1];
+    }
+}
+
+//--------------------------------------------------------------
+// Component decomposition
+//--------------------------------------------------------------
+
+bool DPLLSolver_DS::solve_components(SolveStatus& status) {
+    vector<int> root(num_vars + 1);
+    for (int var = 0; var <= num_vars; var++)
+        root[var] = var;
+    auto find = [&root](int var) {
+        while (root[var] != var)
+            var = root[var] = root[root[var]];
+        return var;
+    };
+    vector<vector<int>> open_clauses;
+    vector<int> lits;
+    auto add_open = [&](auto begin, auto end) {
+        lits.clear();
+        for (auto lit = begin; lit != end; ++lit) {
+            int value = value_of(*lit);
+            if (value == 1)
+                return true;
+            if (value == -1)
+                lits.push_back(*lit);
+        }
+        if (lits.empty())
+            return false;
+        for (int lit : lits)
+            root[find(abs(lit))] = find(abs(lits[0]));
+        open_clauses.push_back(lits);
+        return true;
+    };
+    // In clause and variable order, so that component solvers decide as this one would.
+    for (int idx = 0; idx < (int)original_cnf.size(); idx++) {
+        const ClauseArena::Clause clause = original_cnf[idx];
+        if (unsatisfied_clauses.count(idx) && !add_open(clause.begin(), clause.end()))
+            return false;       // A falsified clause: leave it to the search
+    }
+    for (const auto& group : amo_groups) {
+        for (size_t i = 0; i < group.size(); i++) {
+            for (size_t j = i + 1; j < group.size(); j++) {
+                int pair[2] = {-group[i], -group[j]};
+                if (!add_open(pair, pair + 2))
+                    return false;
+            }
+        }
+    }
+
+    // Number the components by their root and renumber each one's variables from 1.
+    vector<int> component(num_vars + 1, -1), local(num_vars + 1, 0);
+    vector<vector<int>> variables;              // Per component: local variable - 1 -> variable
+    for (const auto& clause : open_clauses) {
+        for (int lit : clause)
+            local[abs(lit)] = 1;
+    }
+    for (int var = 1; var <= num_vars; var++) {
+        if (local[var] == 0)
+            continue;
+        int& id = component[find(var)];
+        if (id == -1) {
+            id = (int)variables.size();
+            variables.emplace_back();
+        }
+        variables[id].push_back(var);
+        local[var] = (int)variables[id].size();
+    }
+    if (variables.size() < 2)
+        return false;
+    vector<vector<vector<int>>> clauses(variables.size());
+    for (auto& clause : open_clauses) {
+        int id = component[find(abs(clause[0]))];
+        for (int& lit : clause)
+            lit = (lit > 0 ? local[lit] : -local[-lit]);
+        clauses[id].push_back(move(clause));
+    }
+    open_clauses = {};
+    // Largest components first, so that the pool is not left waiting on one at the end.
+    vector<size_t> order(variables.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [&clauses](size_t a, size_t b) { return clauses[a].size() > clauses[b].size(); });
+
+    vector<pair<string, double>> parameters;
+    for (const string& name : parameter_names())
+        parameters.emplace_back(name, get_parameter(name));
+    double seconds = 0;
+    if (has_deadline)
+        seconds = max(1e-3, chrono::duration<double>(deadline - chrono::steady_clock::now()).count());
+    long long conflict_budget = (conflict_limit >= 0 ? max(0LL, conflict_limit - conflicts) : -1);
+    atomic<long long> shared_budget(conflict_budget);
+
+    vector<SolveStatus> results(variables.size(), SolveStatus::Unknown);
+    vector<vector<int>> models(variables.size());
+    atomic<size_t> next(0);
+    atomic<bool> stop(false);
+    atomic<long long> component_conflicts(0);
+    atomic<long long> component_dropped(0);
+    mutex lock;
+    condition_variable finished;
+    size_t done = 0;
+    auto work = [&]() {
+        while (true) {
+            size_t i = next++;
+            if (i >= order.size())
+                break;
+            size_t id = order[i];
+            if (!stop) {
+                DPLLSolver_DS solver;
+                for (const auto& parameter : parameters)
+                    solver.set_parameter(parameter.first, parameter.second);
+                solver.set_parameter("decompose", 0);
+                solver.set_parameter("reorder", 0);
+                solver.declare_variables((long long)variables[id].size());
+                for (const auto& clause : clauses[id])
+                    solver.add_clause(clause.data(), clause.data() + clause.size());
+                solver.finish_loading();
+                solver.set_limits(-1, seconds, &stop);
+                if (conflict_budget < 0 || solver.share_conflict_budget(&shared_budget))
+                    results[id] = solver.solve_limited();
+                solver.release_shared_conflicts();
+                if (results[id] == SolveStatus::Satisfiable)
+                    models[id] = solver.get_model();
+                else if (results[id] == SolveStatus::Unsatisfiable)
+                    stop = true;
+                component_conflicts += solver.conflicts;
+                component_dropped += solver.dropped_learned_clauses;
+            }
+            lock_guard<mutex> guard(lock);
+            done++;
+            finished.notify_one();
+        }
+    };
+    unsigned threads = (component_workers > 0 ? component_workers : max(1u, thread::hardware_concurrency()));
+    size_t workers = min<size_t>(threads, order.size());
+    vector<thread> pool;
+    for (size_t i = 0; i < workers; i++) {
+        pool.emplace_back([&work, i] {
+            bind_worker_to_numa_node(i);
+            work();
+        });
+    }
+    {
+        // Wait here rather than work, so that an external cancellation reaches the
+        // component solvers through stop.
+        unique_lock<mutex> guard(lock);
+        while (done < order.size()) {
+            finished.wait_for(guard, chrono::milliseconds(20));
+            if (cancel_flag && cancel_flag->load(memory_order_relaxed))
+                stop = true;
+        }
+    }
+    for (auto& worker : pool)
+        worker.join();
+    conflicts += component_conflicts;
+    dropped_learned_clauses += component_dropped;
+    components_solved = (int)variables.size();
+
+    status = SolveStatus::Satisfiable;
+    for (SolveStatus result : results) {
+        if (result == SolveStatus::Unsatisfiable) {
+            status = result;
+            break;
+        }
+        if (result == SolveStatus::Unknown)
+            status = result;
+    }
+    aborted = (status == SolveStatus::Unknown);
+    if (status != SolveStatus::Satisfiable)
+        return true;
+    for (size_t id = 0; id < variables.size(); id++) {
+        for (int lit : models[id]) {
+            int var = variables[id][abs(lit) - 1];
+            unsigned p = packed_literal(lit > 0 ? var : -var);
+            lit_value[p] = 1;
+            lit_value[p ^ 1] = 0;
+        }
+    }
+    extend_model();
+    return true;
+}
+
+//--------------------------------------------------------------
+// Restarts and clause vivification
+//--------------------------------------------------------------
+
+void DPLLSolver_DS::note_conflict() {
+    SAT_PHASE(Analyze);
+    trace('C');
+    conflicts++;
+    if (shared_conflicts && !(holds_shared_conflict = take_shared_conflict()))
+        conflict_limit = conflicts;
+    if (conflicts >= next_restart && !enumerating)
+        restart_pending = true;
+    if (conflicts == conflict_limit && !stepping)
+        check_limits();
+    if (!snapshot_path.empty() && (conflicts & 1023) == 0 &&
+        chrono::steady_clock::now() - last_snapshot > chrono::duration<double>(snapshot_interval)) {
+        SAT_COUNT_ALLOCATIONS(Off);
+        if (!save_snapshot(snapshot_path))
+            cerr << "Warning: Could not write snapshot " << snapshot_path << ".\n";
+        last_snapshot = chrono::steady_clock::now();
+    }
+}
+
+bool DPLLSolver_DS::share_conflict_budget(atomic<long long>* budget) {
+    shared_conflicts = budget;
+    holds_shared_conflict = take_shared_conflict();
+    return holds_shared_conflict;
+}
+
+void DPLLSolver_DS::release_shared_conflicts() {
+    if (shared_conflicts && holds_shared_conflict)
+        shared_conflicts->fetch_add(1, memory_order_relaxed);
+    shared_conflicts = nullptr;
+    holds_shared_conflict = false;
+}
+
+bool DPLLSolver_DS::take_shared_conflict() {
+    long long left = shared_conflicts->load(memory_order_relaxed);
+    while (left > 0 && !shared_conflicts->compare_exchange_weak(left, left - 1, memory_order_relaxed)) {}
+    return left > 0;
+}
+
+void DPLLSolver_DS::check_limits() {
+    if ((conflict_limit >= 0 && conflicts >= conflict_limit) ||
+        (assignment_limit >= 0 && assignment_count >= assignment_limit) ||
+        (cancel_flag && cancel_flag->load(memory_order_relaxed)) ||
+        (has_deadline && chrono::steady_clock::now() >= deadline)) {
+        if (stepping && !aborted) {
+            resume_decisions = open_decisions;
+            resume_trail = assignments_stack;
+        }
+        aborted = true;
+        restart_pending = true;
+    }
+}
+
+bool DPLLSolver_DS::inprocess_between_restarts() {
+    SAT_PHASE(Preprocess);
+    if (!reduce_learned_clauses())
+        return false;
+    // The vivification budget is time, so a trace records the number of clauses
+    // vivified and a replay vivifies exactly as many.
+    bool replaying = false;
+    long long replay_vivify = -1;
+    char tag;
+    uint64_t value;
+    if (trace_in && trace_in->peek(tag, value)) {
+        if (tag == 'R') {
+            trace_in->next(tag, value);
+            traced_events++;
+            replaying = true;
+            replay_vivify = (long long)value - 1;
+        } else {
+            diverge("a restart");
+        }
+    }
+    double allowed = (core_tracking ? 0.0 : inprocess_effort * search_seconds - inprocess_seconds);
+    if (replaying ? replay_vivify < 0 : allowed <= 0.0) {
+        if (trace_out)
+            trace_out->event('R', 0);
+        return true;
+    }
+    auto start = chrono::steady_clock::now();
+    auto deadline = (replaying ? chrono::steady_clock::time_point::max() :
+                     start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(allowed)));
+    size_t vivified = 0;
+    bool ok = vivify_clauses(deadline, replay_vivify, vivified);
+    if (trace_out)
+        trace_out->event('R', vivified + 1);
+    ok = ok && inprocess();
+    inprocess_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return ok;
+}
+
+void DPLLSolver_DS::trace(char tag, uint64_t value) {
+    if (trace_out)
+        trace_out->event(tag, value);
+    if (trace_in) {
+        char expected;
+        uint64_t expected_value;
+        if (!trace_in->peek(expected, expected_value) || expected != tag || expected_value != value) {
+            diverge(trace_event_text(tag, value));
+        } else {
+            trace_in->next(expected, expected_value);
+            traced_events++;
+        }
+    }
+}
+
+void DPLLSolver_DS::diverge(const string& reached_event) {
+    char tag;
+    uint64_t value;
+    bool more = trace_in->peek(tag, value);
+    replay_divergence = "event " + to_string(traced_events + 1) + ": the search reached " + reached_event +
+                        ", the trace has " + (more ? trace_event_text(tag, value) : string("ended"));
+    trace_in.reset();
+}
+
+bool DPLLSolver_DS::replay_decision(int& branch_lit, bool& replayed) {
+    char tag;
+    uint64_t value;
+    probe_trail.clear();
+    probe_marks.clear();
+    bool fits = true;
+    while (fits && trace_in->peek(tag, value) && tag != 'D') {
+        int lit = unzigzag(value);
+        if (tag == 'P' && value_of(lit) == -1) {
+            probe_marks.push_back(probe_trail.size());
+            propagate(lit, probe_trail);
+        } else if (tag == 'U' && !probe_marks.empty()) {
+            backtrack_to(probe_trail, probe_marks.back());
+            probe_marks.pop_back();
+        } else if (tag == 'F' && probe_marks.empty() && value_of(lit) == -1) {
+            trace_in->next(tag, value);
+            traced_events++;
+            if (trace_out)
+                trace_out->event(tag, value);
+            if (!propagate(lit, assignments_stack))
+                return false;
+            if (unsatisfied_clauses.empty())
+                return true;
+            continue;
+        } else {
+            fits = false;
+            continue;
+        }
+        trace_in->next(tag, value);
+        traced_events++;
+        if (trace_out)
+            trace_out->event(tag, value);
+    }
+    backtrack_to(probe_trail, 0);
+    if (!fits || !trace_in->peek(tag, value) || tag != 'D' || (value != 0 && value_of(unzigzag(value)) != -1)) {
+        diverge("a decision");
+        return true;
+    }
+    trace_in->next(tag, value);
+    traced_events++;
+    branch_lit = unzigzag(value);
+    replayed = true;
+    return true;
+}
+
+bool DPLLSolver_DS::reduce_learned_clauses() {
+    SAT_PHASE(Reduce);
+    if (learned_clauses_count < max_learned_clauses || learned_clauses_count == 0)
+        return true;
+    vector<int>& learned = clause_scratch;
+    learned.clear();
+    for (int idx = num_original_clauses; idx < (int)cnf.size(); idx++)
+        learned.push_back(idx);
+    auto middle = learned.begin() + learned.size() / 2;
+    nth_element(learned.begin(), middle, learned.end(), [this](int a, int b) {
+        return clause_info[a].activity < clause_info[b].activity;
+    });
+    drop_marks.assign(cnf.size(), 0);
+    for (auto it = learned.begin(); it != middle; ++it)
+        drop_marks[*it] = 1;
+    return simplify_root(drop_marks);
+}
+
+bool DPLLSolver_DS::vivify_clauses(chrono::steady_clock::time_point deadline, long long max_clauses, size_t& vivified) {
+    if (!simplify_root())
+        return false;
+    vector<int>& candidates = clause_scratch;
+    candidates.clear();
+    for (int idx = num_original_clauses; idx < (int)cnf.size(); idx++) {
+        if (!clause_info[idx].vivified && cnf[idx].size() > 1)
+            candidates.push_back(idx);
+    }
+    sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        return clause_info[a].activity > clause_info[b].activity;
+    });
+    candidates.resize((candidates.size() + 1) / 2);
+    int originals = min(num_original_clauses, max(16, num_original_clauses / 10));
+    for (int i = 0; i < originals; i++) {
+        int idx = (vivify_cursor + i) % num_original_clauses;
+        if (!clause_info[idx].vivified && cnf[idx].size() > 1)
+            candidates.push_back(idx);
+    }
+    if (num_original_clauses > 0)
+        vivify_cursor = (vivify_cursor + originals) % num_original_clauses;
+
+    drop_marks.assign(cnf.size(), 0);
+    vivified = 0;
+    for (size_t i = 0; i < candidates.size() && !root_conflict; i++) {
+        if (max_clauses >= 0 ? (long long)i >= max_clauses : (i % 16 == 0 && chrono::steady_clock::now() > deadline))
+            break;
+        vivify_clause(candidates[i], drop_marks);
+        vivified = i + 1;
+    }
+    for (auto& info : clause_info)
+        info.activity *= 0.5;
+    if (root_conflict)
+        return false;
+    return simplify_root(drop_marks);
+}
+
+void DPLLSolver_DS::vivify_clause(int idx, vector<char>& drop) {
+    detach_clause(idx);
+    vector<int>& literals = vivify_literals;
+    literals.assign(original_cnf[idx].begin(), original_cnf[idx].end());
+    sort(literals.begin(), literals.end(), [this](int a, int b) {
+        return occurrences[packed_literal(a)].size() + occurrences[packed_literal(-a)].size() >
+               occurrences[packed_literal(b)].size() + occurrences[packed_literal(-b)].size();
+    });
+    // The literals of a clause are distinct, so the kept ones need no set.
+    vector<int>& kept = vivify_kept;
+    vector<int>& trail = probe_trail;
+    kept.clear();
+    trail.clear();
+    bool redundant = false;
+    for (int lit : literals) {
+        int value = value_of(lit);
+        if (value == 0)
+            continue;                       // Implied false: drop it.
+        kept.push_back(lit);
+        if (value != -1 || !propagate(-lit, trail)) {
+            redundant = (kept.size() == literals.size());
+            break;                          // Implied true, or conflict.
+        }
+    }
+    backtrack_to(trail, 0);
+
+    if (redundant && idx >= num_original_clauses) {
+        drop[idx] = 1;
+        return;
+    }
+    original_cnf.shrink(idx, kept);
+    cnf.shrink(idx, kept);
+    clause_info[idx].vivified = true;
+    attach_clause(idx);
+    if (kept.empty())
+        root_conflict = true;
+    else if (kept.size() == 1)
+        root_conflict = !propagate(kept.front(), root_trail);
+}
+
+void DPLLSolver_DS::detach_clause(int idx) {
+    for (unsigned q : original_cnf[idx].packed()) {
+        vector<int>& list = occurrences[q];
+        auto it = find(list.begin(), list.end(), idx);
+        if (it != list.end()) {
+            *it = list.back();
+            list.pop_back();
+        }
+    }
+    unsatisfied_clauses.erase(idx);
+}
+
+void DPLLSolver_DS::attach_clause(int idx) {
+    for (unsigned q : original_cnf[idx].packed())
+        occurrences[q].push_back(idx);
+    unsatisfied_clauses.insert(idx);
+}
+
+void DPLLSolver_DS::decay_counters() {
+    SAT_PHASE(Decide);
+    for (double& activity : lit_activity)
+        activity *= decay_factor;
+}
+
+void DPLLSolver_DS::boost_conflict_literals(const vector<int>& conflict_clause) {
+    for (int lit : conflict_clause)
+        lit_activity[packed_literal(lit)] += conflict_weight;
+    decay_counters();
+}
+
+void DPLLSolver_DS::reserve_search_buffers() {
+    size_t vars = num_vars + 1;
+    size_t cap = max(max_learned_clauses, learned_clauses_count);
+    size_t clauses = num_original_clauses + cap;
+    size_t longest = max(longest_clause, (size_t)max_learned_clause_len);
+    assignments_stack.reserve(vars);
+    amo_queue.reserve(vars);
+    open_decisions.reserve(vars);
+    resume_decisions.reserve(vars);
+    resume_trail.reserve(vars);
+    trail_now.reserve(vars);
+    trail_then.reserve(vars);
+    last_assignment_status.reason.reserve(2 * longest);
+    unit_scratch.reserve(clauses);
+    pure_scratch.reserve(2 * vars);
+    tallied_literals.reserve(2 * vars);
+    lookahead_scratch.reserve(vars);
+    ranked_scratch.reserve(vars);
+    probe_trail.reserve(vars);
+    probe_marks.reserve(vars);
+    cube_scratch.reserve(vars);
+    root_trail.reserve(vars);
+    eliminated.reserve(vars);
+    clause_scratch.reserve(clauses);
+    drop_marks.reserve(clauses);
+    compact_source.reserve(clauses);
+    compact_kept.reserve(longest);
+    info_scratch.reserve(clauses);
+    vivify_literals.reserve(longest);
+    vivify_kept.reserve(longest);
+    probe_stamp.reserve(2 * vars);
+    necessary_scratch.reserve(vars);
+    implication_start.reserve(2 * vars + 1);
+    implication_edges.reserve(2 * clauses);
+    for (vector<int>* buffer : {&tarjan_index, &tarjan_lowlink, &scc_component, &scc_scratch})
+        buffer->reserve(2 * vars);
+    scc_on_stack.reserve(2 * vars);
+    tarjan_calls.reserve(2 * vars);
+    substitute_scratch.reserve(vars);
+    size_t learned_literals = cap * max_learned_clause_len;
+    size_t arena_literals = original_cnf.used_literals() + original_cnf.free_literals();
+    original_cnf.reserve(clauses, arena_literals + learned_literals);
+    cnf.reserve(clauses, cnf.literal_count() + learned_literals);
+    clause_info.reserve(clauses);
+    unsatisfied_clauses.reserve(clauses);
+    // Headroom for learned clauses in every occurrence list: a few times a literal's
+    // share of the learned literals, at least 16.
+    occurrence_headroom = min(cap, max<size_t>(16, 4 * learned_literals / (2 * vars)));
+    for (auto& list : occurrences)
+        list.reserve(list.size() + occurrence_headroom);
+    occurrences_full = false;
+}
+
+void DPLLSolver_DS::regrow_occurrence_lists() {
+    if (!occurrences_full)
+        return;
+    SAT_COUNT_ALLOCATIONS(Off);
+    for (auto& list : occurrences) {
+        if (list.size() == list.capacity())
+            list.reserve(2 * list.size() + occurrence_headroom);
+    }
+    occurrences_full = false;
+}
+
+void DPLLSolver_DS::reserve_proof_nodes() {
+    if (!core_tracking)
+        return;
+    SAT_COUNT_ALLOCATIONS(Off);
+    size_t room = max(0, max_learned_clauses - learned_clauses_count);
+    proof_start.reserve(proof_start.size() + room);
+    proof_parents.reserve(proof_parents.size() + 2 * room);
+    core_mark.reserve(core_mark.size() + room);
+    root_uses.reserve(core_mark.capacity());
+    episode_uses.reserve(core_mark.capacity());
+}
+
+int DPLLSolver_DS::input_literal(int literal) const {
+    if (input_var.empty())
+        return literal;
+    return literal > 0 ? input_var[literal] : -input_var[-literal];
+}
+
+void DPLLSolver_DS::fix_variable_order() {
+    if (order_fixed)
+        return;
+    order_fixed = true;
+    if (reorder && !core_tracking)          // Would renumber the input clauses
+        renumber_for_locality();
+}
+
+void DPLLSolver_DS::renumber_for_locality() {
+    get_formula_key();              // The key stays that of the input numbering
+    int clause_count = (int)cnf.size();
+    vector<int> degree(num_vars + 1, 0);
+    for (int idx = 0; idx < clause_count; idx++) {
+        const ClauseArena::Clause clause = original_cnf[idx];
+        for (int lit : clause)
+            degree[abs(lit)] += (int)clause.size() - 1;
+    }
+    auto by_degree = [&degree](int a, int b) { return degree[a] < degree[b]; };
+    vector<int> starts;
+    for (int var = 1; var <= num_vars; var++) {
+        if (!occurrences[packed_literal(var)].empty() || !occurrences[packed_literal(-var)].empty())
+            starts.push_back(var);
+    }
+    stable_sort(starts.begin(), starts.end(), by_degree);
+    vector<int> order;
+    order.reserve(num_vars);
+    vector<char> placed(num_vars + 1, 0), expanded(clause_count, 0);
+    for (int start : starts) {
+        if (placed[start])
+            continue;
+        placed[start] = 1;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            int var = order[head];
+            for (int lit : {var, -var}) {
+                for (int idx : occurrences[packed_literal(lit)]) {
+                    if (expanded[idx])
+                        continue;
+                    expanded[idx] = 1;
+                    size_t first = order.size();
+                    for (int other : original_cnf[idx]) {
+                        if (!placed[abs(other)]) {
+                            placed[abs(other)] = 1;
+                            order.push_back(abs(other));
+                        }
+                    }
+                    stable_sort(order.begin() + first, order.end(), by_degree);
+                }
+            }
+        }
+    }
+    // Declared variables that occur in no clause go last.
+    for (int var = 1; var <= num_vars; var++) {
+        if (!placed[var])
+            order.push_back(var);
+    }
+    input_var.assign(num_vars + 1, 0);
+    solver_var.assign(num_vars + 1, 0);
+    for (int i = 0; i < num_vars; i++) {
+        input_var[i + 1] = order[i];
+        solver_var[order[i]] = i + 1;
+    }
+    auto renamed = [this](int lit) { return lit > 0 ? solver_var[lit] : -solver_var[-lit]; };
+
+    vector<vector<int>> clauses(clause_count);
+    for (int idx = 0; idx < clause_count; idx++) {
+        for (int lit : original_cnf[idx])
+            clauses[idx].push_back(renamed(lit));
+        sort(clauses[idx].begin(), clauses[idx].end(), [](int a, int b) { return abs(a) < abs(b); });
+    }
+    auto by_first_var = [&clauses](int a, int b) { return abs(clauses[a][0]) < abs(clauses[b][0]); };
+    vector<int> original_order(num_original_clauses), learned_order;
+    for (int idx = 0; idx < num_original_clauses; idx++)
+        original_order[idx] = idx;
+    for (int idx = num_original_clauses; idx < clause_count; idx++)
+        learned_order.push_back(idx);
+    stable_sort(original_order.begin(), original_order.end(), by_first_var);
+    stable_sort(learned_order.begin(), learned_order.end(), by_first_var);
+
+    large_vector<double> activity(lit_activity.size(), 0.0);
+    large_vector<int8_t> phase(saved_phase.size(), -1);
+    for (int var = 1; var <= num_vars; var++) {
+        activity[packed_literal(solver_var[var])] = lit_activity[packed_literal(var)];
+        activity[packed_literal(-solver_var[var])] = lit_activity[packed_literal(-var)];
+        phase[solver_var[var]] = saved_phase[var];
+    }
+    lit_activity.swap(activity);
+    saved_phase.swap(phase);
+
+    // Load the clauses again in the new order; the original ones go through
+    // add_clause() as at loading, which also collects the unit clauses again.
+    cnf.clear();
+    original_cnf.clear();
+    clause_info.clear();
+    unsatisfied_clauses.clear();
+    for (auto& list : occurrences)
+        list.clear();
+    input_units.clear();
+    input_unit_ids.clear();
+    num_original_clauses = 0;
+    input_clauses = 0;
+    input_literals = 0;
+    for (int idx : original_order)
+        add_clause(clauses[idx].data(), clauses[idx].data() + clauses[idx].size());
+    finish_loading();
+    for (int idx : learned_order) {
+        cnf.emplace_back(clauses[idx].begin(), clauses[idx].end());
+        original_cnf.push_back(clauses[idx]);
+        clause_info.push_back(ClauseInfo());
+        attach_clause((int)cnf.size() - 1);
+    }
+}
+
+void DPLLSolver_DS::resize_variables(int count) {
+    num_vars = count;
+    lit_value.resize(2 * (count + 1), -1);
+    occurrences.resize(2 * (count + 1));
+    lit_activity.resize(2 * (count + 1), 0.0);
+    literal_tally.resize(2 * (count + 1), 0.0);
+    saved_phase.resize(count + 1, -1);
+    amo_occurrences.resize(2 * (count + 1));
+}
+
+//--------------------------------------------------------------
+// MappedFile members
+//--------------------------------------------------------------
+
+MappedFile::MappedFile(const string& path)
+    : bytes(nullptr), length(0), mapped(false)
+{
+#ifdef SAT_HAVE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("Error: Cannot open file " + path + ".");
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw runtime_error("Error: Cannot read file " + path + ".");
+    }
+    length = (size_t)st.st_size;
+    if (length > 0) {
+        void* region = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (region == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Error: Cannot map file " + path + ".");
+        }
+        bytes = static_cast<const char*>(region);
+        mapped = true;
+    }
+    close(fd);
+#else
+    ifstream in(path, ios::binary);
+    if (!in)
+        throw runtime_error("Error: Cannot open file " + path + ".");
+    buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    bytes = buffer.data();
+    length = buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef SAT_HAVE_MMAP
+    if (mapped)
+        munmap(const_cast<char*>(bytes), length);
+#endif
+}
+
+void MappedFile::advise_sequential() const {
+#ifdef SAT_HAVE_MMAP
+    if (mapped)
+        madvise(const_cast<char*>(bytes), length, MADV_SEQUENTIAL);
+#endif
+}
+
+//--------------------------------------------------------------
+// ChunkedDimacsParser members
+//--------------------------------------------------------------
+
+ChunkedDimacsParser::ChunkedDimacsParser(const string& filename, unsigned threads)
+    : file(new MappedFile(filename)), workers(max(1u, threads)), next_chunk(0)
+{
+    file->advise_sequential();
+    split(file->data(), file->size());
+}
+
+ChunkedDimacsParser::ChunkedDimacsParser(const char* text, size_t length, unsigned threads)
+    : workers(max(1u, threads)), next_chunk(0)
+{
+    split(text, length);
+}
+
+ParsedCnf ChunkedDimacsParser::parse_all() {
+    ParsedCnf result;
+    vector<size_t> literal_offset, clause_offset;
+    vector<bool> drop_first;
+    size_t carry = 0, literals = 0, clauses = 0;
+    size_t used = 0;
+    run([&](const Chunk& chunk) {
+        // A leading 0 only ends a clause if earlier chunks left one open.
+        bool drop = chunk.leading_zero && carry == 0;
+        literal_offset.push_back(literals);
+        clause_offset.push_back(clauses);
+        drop_first.push_back(drop);
+        literals += chunk.literals.size();
+        clauses += chunk.ends.size() - (drop ? 1 : 0);
+        carry = (chunk.ends.empty() ? carry + chunk.literals.size() : chunk.literals.size() - chunk.ends.back());
+        note_header(result, chunk);
+        used++;
+    });
+    result.literals.resize(literals);
+    result.offsets.resize(clauses + 1 + (carry > 0 ? 1 : 0));
+    result.offsets[0] = 0;
+    auto copy_chunks = [&](size_t first, size_t step) {
+        for (size_t i = first; i < used; i += step) {
+            const Chunk& chunk = chunks[i];
+            copy(chunk.literals.begin(), chunk.literals.end(), result.literals.begin() + literal_offset[i]);
+            size_t k = clause_offset[i] + 1;
+            for (size_t e = (drop_first[i] ? 1 : 0); e < chunk.ends.size(); e++)
+                result.offsets[k++] = literal_offset[i] + chunk.ends[e];
+        }
+    };
+    unsigned spawn = (used > 1 ? min<unsigned>(workers, (unsigned)used) : 0);
+    vector<thread> pool;
+    for (unsigned t = 0; t < spawn; t++)
+        pool.emplace_back(copy_chunks, t, spawn);
+    if (spawn == 0)
+        copy_chunks(0, 1);
+    for (auto& t : pool)
+        t.join();
+    if (carry > 0)
+        result.offsets.back() = literals;      // Final clause without a terminating 0
+    chunks.clear();
+    validate_header(result);
+    return result;
+}
+
+void ChunkedDimacsParser::note_header(ParsedCnf& result, const Chunk& chunk) {
+    if (chunk.header_vars >= 0) {
+        if (result.header_vars >= 0)
+            throw runtime_error("Error: CNF file has more than one problem line.");
+        result.header_vars = chunk.header_vars;
+        result.header_clauses = chunk.header_clauses;
+    }
+    result.max_var = max(result.max_var, chunk.max_var);
+}
+
+void ChunkedDimacsParser::validate_header(const ParsedCnf& result) {
+    if (result.header_vars < 0)
+        return;
+    if (result.max_var > result.header_vars)
+        throw runtime_error("Error: CNF file uses variable " + to_string(result.max_var) +
+                            " but its header declares " + to_string(result.header_vars) + " variables.");
+    if ((long long)result.clauses() != result.header_clauses)
+        throw runtime_error("Error: CNF file has " + to_string(result.clauses()) +
+                            " clauses but its header declares " + to_string(result.header_clauses) + ".");
+}
+
+void ChunkedDimacsParser::split(const char* text, size_t length) {
+    const size_t min_chunk = 1 << 20;
+    size_t wanted = max<size_t>(1, min(length / min_chunk, (size_t)workers * 4));
+    const char* p = text;
+    const char* end = text + length;
+    for (size_t i = 1; i <= wanted && p < end; i++) {
+        const char* cut = (i == wanted ? end : text + length * i / wanted);
+
+        if (cut < p)
+            cut = p;
+        const char* newline = static_cast<const char*>(memchr(cut, '\n', end - cut));
+        cut = (newline && i != wanted ? newline + 1 : end);
+        chunks.emplace_back();
+        chunks.back().begin = p;
+        chunks.back().end = cut;
+        p = cut;
+    }
+    done.assign(chunks.size(), 0);
+}
+
+void ChunkedDimacsParser::work() {
+    while (true) {
+        size_t i = next_chunk.fetch_add(1);
+        if (i >= chunks.size())
+            return;
+        try {
+            parse_chunk(chunks[i]);
+        } catch (const exception& e) {
+            chunks[i].error = e.what();
+        }
+        lock_guard<mutex> lock(m);
+        done[i] = 1;
+        chunk_done.notify_all();
+    }
+}
+
+void ChunkedDimacsParser::parse_chunk(Chunk& chunk) {
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    chunk.literals.reserve((end - p) / 4);
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            p++;
+        if (p == end)
+            break;
+        if (*p == 'c' || *p == 'p' || *p == '%') {
+            const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (!line_end)
+                line_end = end;
+            if (*p == 'p') {
+                istringstream iss(string(p, line_end));
+                string tag, format;
+                if (!(iss >> tag >> format >> chunk.header_vars >> chunk.header_clauses) || format != "cnf" ||
+                    chunk.header_vars < 0 || chunk.header_clauses < 0)
+                    throw runtime_error("Error: Malformed problem line in CNF file.");
+            } else if (*p == '%') {
+                chunk.stop = true;
+                return;
+            }
+            p = line_end;
+            continue;
+        }
+        bool negative = (*p == '-');
+        if (negative)
+            p++;
+        if (p == end || *p < '0' || *p > '9')
+            throw runtime_error("Error: Unexpected character in CNF file.");
+        long long value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (*p - '0');
+            if (value > INT32_MAX)
+                throw runtime_error("Error: Literal out of range in CNF file.");
+            p++;
+        }
+        if (value != 0) {
+            chunk.literals.push_back(negative ? -(int)value : (int)value);
+            chunk.max_var = max(chunk.max_var, (int)value);
+            continue;
+        }
+        size_t since_last = chunk.literals.size() - (chunk.ends.empty() ? 0 : chunk.ends.back());
+        if (chunk.ends.empty() && since_last == 0) {
+            chunk.leading_zero = true;
+            chunk.ends.push_back(0);
+        } else if (since_last > 0) {
+            chunk.ends.push_back(chunk.literals.size());
+        }
+    }
+}
+
+ParsedCnf load_cnf(const string& filename) {
+    ParsedCnf parsed = ChunkedDimacsParser(filename, thread::hardware_concurrency()).parse_all();
+    if (parsed.clauses() == 0)
+    {
+        throw runtime_error("Error: No valid clauses found in CNF file.");
+    }
+    return parsed;
+}
+
+void load_cnf_pipelined(ChunkedDimacsParser& parser, DPLLSolver_DS& solver) {
+    SAT_PHASE(Parse);
+    ParsedCnf summary;
+    vector<int> open_clause;        // Literals of a clause that continues into the next chunk
+    size_t added = 0;
+    parser.run([&](const ChunkedDimacsParser::Chunk& chunk) {
+        if (chunk.header_clauses > 0 && added == 0)
+            solver.reserve_clauses((size_t)chunk.header_clauses);
+        ChunkedDimacsParser::note_header(summary, chunk);
+        const int* lits = chunk.literals.data();
+        size_t start = 0;
+        for (size_t e = 0; e < chunk.ends.size(); e++) {
+            size_t stop = chunk.ends[e];
+            if (e == 0 && !open_clause.empty()) {
+                open_clause.insert(open_clause.end(), lits, lits + stop);
+                solver.add_clause(open_clause.data(), open_clause.data() + open_clause.size());
+                open_clause.clear();
+                added++;
+            } else if (stop > start) {
+                solver.add_clause(lits + start, lits + stop);
+                added++;
+            }
+            start = stop;
+        }
+        open_clause.insert(open_clause.end(), lits + start, lits + chunk.literals.size());
+    });
+    if (!open_clause.empty()) {
+        solver.add_clause(open_clause.data(), open_clause.data() + open_clause.size());
+        added++;
+    }
+    summary.offsets.resize(added + 1);
+    ChunkedDimacsParser::validate_header(summary);
+    if (added == 0)
+        throw runtime_error("Error: No valid clauses found in CNF file.");
+    solver.declare_variables(summary.header_vars);
+    solver.finish_loading();
+}
+
+void load_cnf_pipelined(const string& filename, DPLLSolver_DS& solver) {
+    ChunkedDimacsParser parser(filename, thread::hardware_concurrency());
+    load_cnf_pipelined(parser, solver);
+}
+
+void load_solver_config(const string& path, DPLLSolver_DS& solver) {
+    ifstream in(path);
+    if (!in)
+        throw runtime_error("Error: Cannot open config file " + path + ".");
+    string line;
+    int line_number = 0;
+    while (getline(in, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        size_t eq = line.find('=');
+        if (line.find_first_not_of(" \t\r") == string::npos)
+            continue;
+        string name, extra;
+        double value;
+        istringstream key(eq == string::npos ? line : line.substr(0, eq));
+        istringstream val(eq == string::npos ? "" : line.substr(eq + 1));
+        if (!(key >> name) || (key >> extra) || !(val >> value) || (val >> extra))
+            throw runtime_error("Error: Malformed line " + to_string(line_number) + " in config file " + path + ".");
+        if (!solver.set_parameter(name, value))
+            throw runtime_error("Error: Unknown parameter or bad value for " + name + " in config file " + path + ".");
+    }
+}
+
+void print_solver_config(ostream& out, const DPLLSolver_DS& solver) {
+    for (const string& name : DPLLSolver_DS::parameter_names())
+        out << name << " = " << solver.get_parameter(name) << "\n";
+}
+
+//--------------------------------------------------------------
+// C API (satsolver.h), for in-process use from other languages
+//--------------------------------------------------------------
+
+// Memory attributed to one handle: the growth of the heap in use where glibc can tell
+// (so it excludes the host process and memory freed again), else of the resident set.
+static double api_memory_kb() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (info.uordblks + info.hblkhd) / 1024.0;
+#else
+    return get_memory_usage();
+#endif
+}
+
+struct sat_solver {
+    DPLLSolver_DS solver;
+    atomic<bool> cancel;
+    bool loaded;                    // finish_loading() has run: no more clauses
+    int clauses;                    // Input clauses kept at loading (before simplification)
+    SolveStatus status;
+    double solve_seconds;
+    double start_memory;
+    string error;
+    sat_solver() : cancel(false), loaded(false), clauses(0), status(SolveStatus::Unknown), solve_seconds(0.0),
+                   start_memory(api_memory_kb()) {}
+};
+
+// Run one API call, turning exceptions into SAT_ERROR and the handle's error message.
+template <typename Call>
+static int sat_guard(sat_solver* handle, Call call) {
+    if (!handle)
+        return SAT_ERROR;
+    handle->error.clear();
+    try {
+        return call();
+    } catch (const exception& e) {
+        handle->error = e.what();
+    } catch (...) {
+        handle->error = "Error: Unknown failure.";
+    }
+    return SAT_ERROR;
+}
+
+static void sat_check_open(const sat_solver* handle) {
+    if (handle->loaded)
+        throw runtime_error("Error: Clauses cannot be added once solving has started.");
+}
+
+extern "C" {
+
+SAT_API int sat_api_version(void) {
+    return SAT_API_VERSION;
+}
+
+SAT_API sat_solver* sat_create(void) {
+    try {
+        return new sat_solver();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+SAT_API void sat_destroy(sat_solver* handle) {
+    delete handle;
+}
+
+SAT_API int sat_add_clauses(sat_solver* handle, const int* literals, size_t count) {
+    return sat_guard(handle, [&] {
+        sat_check_open(handle);
+        if (count > 0 && (!literals || literals[count - 1] != 0))
+            throw runtime_error("Error: The literal buffer must end with a 0 terminating the last clause.");
+        size_t start = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (literals[i] == INT_MIN)
+                throw runtime_error("Error: Literal out of range.");
+            if (literals[i] == 0) {
+                handle->solver.add_clause(literals + start, literals + i);
+                start = i + 1;
+            }
+        }
+        return 0;
+    });
+}
+
+SAT_API int sat_add_dimacs(sat_solver* handle, const char* text, size_t length) {
+    return sat_guard(handle, [&] {
+        sat_check_open(handle);
+        ParsedCnf parsed = ChunkedDimacsParser(text, length, 1).parse_all();
+        for (size_t i = 0; i < parsed.clauses(); i++)
+            handle->solver.add_clause(parsed.literals.data() + parsed.offsets[i], parsed.literals.data() + parsed.offsets[i + 1]);
+        handle->solver.declare_variables(parsed.header_vars);
+        return 0;
+    });
+}
+
+SAT_API int sat_set_parameter(sat_solver* handle, const char* name, double value) {
+    return sat_guard(handle, [&] {
+        if (!name || !handle->solver.set_parameter(name, value))
+            throw runtime_error(string("Error: Invalid parameter ") + (name ? name : "(null)") + ".");
+        return 0;
+    });
+}
+
+SAT_API int sat_load_config(sat_solver* handle, const char* path) {
+    return sat_guard(handle, [&] {
+        load_solver_config(path ? path : "", handle->solver);
+        return 0;
+    });
+}
+
+SAT_API int sat_solve(sat_solver* handle, long long conflict_limit, double time_limit) {
+    return sat_guard(handle, [&] {
+        if (handle->status == SolveStatus::Unknown) {
+            auto start = chrono::steady_clock::now();
+            if (!handle->loaded) {
+                handle->loaded = true;
+                handle->clauses = handle->solver.num_original_clauses;
+                handle->solver.finish_loading();
+            }
+            handle->cancel = false;
+            handle->solver.set_limits(conflict_limit, time_limit, &handle->cancel);
+            handle->status = handle->solver.solve_limited();
+            handle->solve_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        return (handle->status == SolveStatus::Satisfiable ? SAT_SATISFIABLE :
+                handle->status == SolveStatus::Unsatisfiable ? SAT_UNSATISFIABLE : SAT_UNKNOWN);
+    });
+}
+
+SAT_API void sat_interrupt(sat_solver* handle) {
+    if (handle)
+        handle->cancel = true;
+}
+
+SAT_API int sat_value(const sat_solver* handle, int var) {
+    if (!handle || handle->status != SolveStatus::Satisfiable || var <= 0 || var > handle->solver.num_variables())
+        return 0;
+    return (handle->solver.input_value(var) == 1 ? var : -var);
+}
+
+SAT_API size_t sat_model(const sat_solver* handle, int* model, size_t capacity) {
+    if (!handle || handle->status != SolveStatus::Satisfiable)
+        return 0;
+    size_t vars = (size_t)handle->solver.num_variables();
+    for (size_t var = 1; var <= vars && var <= capacity; var++)
+        model[var - 1] = sat_value(handle, (int)var);
+    return vars;
+}
+
+SAT_API int sat_statistic(const sat_solver* handle, const char* name, double* value) {
+    if (!handle || !name || !value)
+        return SAT_ERROR;
+    const DPLLSolver_DS& solver = handle->solver;
+    string key = name;
+    if (key == "variables")
+        *value = solver.num_variables();
+    else if (key == "clauses")
+        *value = (handle->loaded ? handle->clauses : solver.num_original_clauses);
+    else if (key == "conflicts")
+        *value = (double)solver.conflicts;
+    else if (key == "restarts")
+        *value = solver.restarts;
+    else if (key == "dropped_learned")
+        *value = (double)solver.dropped_learned_clauses;
+    else if (key == "assignments")
+        *value = (double)solver.assignments();
+    else if (key == "components")
+        *value = solver.components_solved;
+    else if (key == "seconds")
+        *value = handle->solve_seconds;
+    else if (key == "memory_kb")
+        *value = max(0.0, api_memory_kb() - handle->start_memory);
+    else
+        return SAT_ERROR;
+    return 0;
+}
+
+SAT_API const char* sat_last_error(const sat_solver* handle) {
+    return handle ? handle->error.c_str() : "Error: No solver.";
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * C API of the DPLL_CDCL_VSIDS solver, built from satsolver.cpp as libsatsolver.so
+ * (make libsatsolver.so). Link with -lsatsolver; solver.h is the C++ interface.
+ *
+ * A solver handle holds one formula. Clauses are added before the first sat_solve();
+ * sat_solve() may be called again after it returned SAT_UNKNOWN and then continues
+ * with what it has learned. No function throws; a call that fails returns SAT_ERROR
+ * (or NULL) and sat_last_error() describes why. A handle must not be used by two
+ * threads at once, except for sat_interrupt(), which may be called from any thread.
+ */
+#ifndef SATSOLVER_H
+#define SATSOLVER_H
+
+#include <stddef.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#ifdef SAT_BUILDING_LIBRARY
+#define SAT_API __declspec(dllexport)
+#else
+#define SAT_API __declspec(dllimport)
+#endif
+#else
+#define SAT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Version of this interface; raised only for incompatible changes. */
+#define SAT_API_VERSION 1
+
+/* Results of sat_solve(), as in IPASIR. */
+#define SAT_UNKNOWN 0
+#define SAT_SATISFIABLE 10
+#define SAT_UNSATISFIABLE 20
+#define SAT_ERROR (-1)
+
+typedef struct sat_solver sat_solver;
+
+SAT_API int sat_api_version(void);
+
+/* A new, empty solver; NULL if out of memory. */
+SAT_API sat_solver* sat_create(void);
+SAT_API void sat_destroy(sat_solver* solver);
+
+/* Add clauses given as literals, each clause terminated by 0. The buffer must end
+ * with a complete clause. Returns 0 or SAT_ERROR. */
+SAT_API int sat_add_clauses(sat_solver* solver, const int* literals, size_t count);
+
+/* Add the clauses of DIMACS CNF text (not necessarily NUL-terminated). Returns 0 or
+ * SAT_ERROR. */
+SAT_API int sat_add_dimacs(sat_solver* solver, const char* text, size_t length);
+
+/* Set a search parameter, by the names --print-config lists; returns 0 or SAT_ERROR.
+ * sat_load_config() reads a --config file. */
+SAT_API int sat_set_parameter(sat_solver* solver, const char* name, double value);
+SAT_API int sat_load_config(sat_solver* solver, const char* path);
+
+/* Solve within the limits: at most conflict_limit more conflicts (-1: none) and
+ * time_limit seconds (<= 0: none). Returns SAT_SATISFIABLE, SAT_UNSATISFIABLE,
+ * SAT_UNKNOWN (a limit or sat_interrupt() stopped the search) or SAT_ERROR. */
+SAT_API int sat_solve(sat_solver* solver, long long conflict_limit, double time_limit);
+
+/* Stop a running sat_solve() soon; it returns SAT_UNKNOWN. The request is cleared
+ * when the next sat_solve() starts. */
+SAT_API void sat_interrupt(sat_solver* solver);
+
+/* After SAT_SATISFIABLE: the literal of variable var that is true in the model (var
+ * or -var), or 0 if there is no model or var is out of range. */
+SAT_API int sat_value(const sat_solver* solver, int var);
+
+/* After SAT_SATISFIABLE: copy up to capacity model literals in variable order into
+ * model and return the number of variables (call with capacity 0 to size the
+ * buffer); 0 if there is no model. */
+SAT_API size_t sat_model(const sat_solver* solver, int* model, size_t capacity);
+
+/* Read a statistic: "variables", "clauses", "conflicts", "restarts", "assignments",
+ * "components", "dropped_learned" (learned clauses not kept because an occurrence list
+ * was full until the next restart), "seconds" (total time in sat_solve) or "memory_kb"
+ * (heap the handle holds where glibc reports it, else the growth of the process's
+ * resident set).
+ * Returns 0 or SAT_ERROR for an unknown name. */
+SAT_API int sat_statistic(const sat_solver* solver, const char* name, double* value);
+
+/* Message of the last failed call on this handle ("" if none). Valid until the next
+ * call on the handle. */
+SAT_API const char* sat_last_error(const sat_solver* solver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,140 @@
+import ctypes
+import os
+
+# ctypes binding of libsatsolver.so, the C API of DPLL_CDCL_VSIDS (see satsolver.h).
+# The library is looked up in $SATSOLVER_LIBRARY, then next to this file.
+
+SAT_UNKNOWN = 0
+SAT_SATISFIABLE = 10
+SAT_UNSATISFIABLE = 20
+SAT_ERROR = -1
+API_VERSION = 1
+
+RESULTS = {SAT_SATISFIABLE: "SAT", SAT_UNSATISFIABLE: "UNSAT", SAT_UNKNOWN: "UNKNOWN"}
+
+_library = None
+
+
+class SolverError(RuntimeError):
+    pass
+
+
+def library_path():
+    return os.environ.get("SATSOLVER_LIBRARY") or \
+        os.path.join(os.path.dirname(os.path.abspath(__file__)), "libsatsolver.so")
+
+
+def load_library(path=None):
+    global _library
+    if _library is not None and path is None:
+        return _library
+    lib = ctypes.CDLL(path or library_path())
+    handle = ctypes.c_void_p
+    signatures = {
+        "sat_api_version": (ctypes.c_int, []),
+        "sat_create": (handle, []),
+        "sat_destroy": (None, [handle]),
+        "sat_add_clauses": (ctypes.c_int, [handle, ctypes.POINTER(ctypes.c_int), ctypes.c_size_t]),
+        "sat_add_dimacs": (ctypes.c_int, [handle, ctypes.c_char_p, ctypes.c_size_t]),
+        "sat_set_parameter": (ctypes.c_int, [handle, ctypes.c_char_p, ctypes.c_double]),
+        "sat_load_config": (ctypes.c_int, [handle, ctypes.c_char_p]),
+        "sat_solve": (ctypes.c_int, [handle, ctypes.c_longlong, ctypes.c_double]),
+        "sat_interrupt": (None, [handle]),
+        "sat_value": (ctypes.c_int, [handle, ctypes.c_int]),
+        "sat_model": (ctypes.c_size_t, [handle, ctypes.POINTER(ctypes.c_int), ctypes.c_size_t]),
+        "sat_statistic": (ctypes.c_int, [handle, ctypes.c_char_p, ctypes.POINTER(ctypes.c_double)]),
+        "sat_last_error": (ctypes.c_char_p, [handle]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+    if lib.sat_api_version() != API_VERSION:
+        raise SolverError(f"{path or library_path()} implements API version {lib.sat_api_version()}, "
+                          f"expected {API_VERSION}")
+    if path is None:
+        _library = lib
+    return lib
+
+
+class Solver:
+    """One formula solved in-process. Calls release the GIL, so solvers on different
+    threads run in parallel; interrupt() may be called from another thread."""
+
+    def __init__(self, library=None):
+        self.lib = library or load_library()
+        self.handle = self.lib.sat_create()
+        if not self.handle:
+            raise MemoryError("sat_create failed")
+
+    def close(self):
+        if self.handle:
+            self.lib.sat_destroy(self.handle)
+            self.handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def _check(self, status):
+        if status == SAT_ERROR:
+            raise SolverError(self.lib.sat_last_error(self.handle).decode())
+        return status
+
+    def add_clauses(self, clauses):
+        literals = [lit for clause in clauses for lit in (*clause, 0)]
+        buffer = (ctypes.c_int * len(literals))(*literals)
+        self._check(self.lib.sat_add_clauses(self.handle, buffer, len(literals)))
+
+    def add_dimacs(self, text):
+        if isinstance(text, str):
+            text = text.encode()
+        self._check(self.lib.sat_add_dimacs(self.handle, text, len(text)))
+
+    def set_parameter(self, name, value):
+        self._check(self.lib.sat_set_parameter(self.handle, name.encode(), value))
+
+    def load_config(self, path):
+        self._check(self.lib.sat_load_config(self.handle, os.fsencode(path)))
+
+    def solve(self, conflict_limit=-1, time_limit=0.0):
+        """"SAT", "UNSAT", or "UNKNOWN" if a limit or interrupt() stopped the search."""
+        return RESULTS[self._check(self.lib.sat_solve(self.handle, conflict_limit, time_limit))]
+
+    def interrupt(self):
+        self.lib.sat_interrupt(self.handle)
+
+    def model(self):
+        """Literals of the model in variable order ([] unless the last solve was SAT)."""
+        count = self.lib.sat_model(self.handle, None, 0)
+        buffer = (ctypes.c_int * count)()
+        self.lib.sat_model(self.handle, buffer, count)
+        return list(buffer)
+
+    def statistic(self, name):
+        value = ctypes.c_double()
+        if self.lib.sat_statistic(self.handle, name.encode(), ctypes.byref(value)) != 0:
+            raise KeyError(name)
+        return value.value
+
+
+def solve_file(cnf_path, time_limit=0.0, conflict_limit=-1, config=None, parameters=None):
+    """Solve a DIMACS file in-process; returns (result, solver statistics). parameters
+    ({name: value}) are applied after config."""
+    with open(cnf_path, "rb") as f:
+        text = f.read()
+    with Solver() as solver:
+        if config:
+            solver.load_config(config)
+        for name, value in (parameters or {}).items():
+            solver.set_parameter(name, value)
+        solver.add_dimacs(text)
+        result = solver.solve(conflict_limit, time_limit)
+        stats = {name: solver.statistic(name)
+                 for name in ("variables", "clauses", "conflicts", "restarts", "seconds", "memory_kb")}
+        return result, stats
@@ -0,0 +1,1204 @@
+// DPLL + CDCL + VSIDS: C++ interface of the solver library (libsatsolver.so)
+//
+// The solver class with its clause stores, and the DIMACS parser and parameter files that
+// the executable and the C API (satsolver.h) share. Everything declared here is defined
+// in satsolver.cpp.
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "satsolver.h"
+
+// Packed literal encoding, 2 * var + sign (sign 1 for a negative literal): the two
+// literals of a variable are neighbours and p ^ 1 is the negation of p.
+inline unsigned packed_literal(int literal) {
+    return literal > 0 ? 2u * literal : 2u * (unsigned)(-literal) + 1u;
+}
+
+inline int unpacked_literal(unsigned packed) {
+    return (packed & 1) ? -(int)(packed >> 1) : (int)(packed >> 1);
+}
+
+// Packed literals of one stored clause, for the loops that index per-literal arrays.
+struct PackedLiterals {
+    const unsigned* first;
+    const unsigned* last;
+    const unsigned* begin() const { return first; }
+    const unsigned* end() const { return last; }
+};
+
+// Iterates packed literals, yielding their signed form.
+class UnpackingIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = ptrdiff_t;
+    using pointer = const int*;
+    using reference = int;
+
+    explicit UnpackingIterator(const unsigned* position) : position(position) {}
+    int operator*() const { return unpacked_literal(*position); }
+    UnpackingIterator& operator++() { ++position; return *this; }
+    UnpackingIterator operator++(int) { UnpackingIterator old = *this; ++position; return old; }
+    bool operator==(const UnpackingIterator& other) const { return position == other.position; }
+    bool operator!=(const UnpackingIterator& other) const { return position != other.position; }
+
+private:
+    const unsigned* position;
+};
+
+// Structure for assignment status (used for conflict analysis).
+struct AssignmentStatus {
+    bool conflict;
+    std::vector<int> reason;            // Literals of the conflict, without repeats
+    int clauses[2];                     // The two clauses reason is the resolvent of
+    AssignmentStatus() : conflict(false), clauses{-1, -1} {}
+};
+
+// 128-bit content key of a formula.
+struct FormulaKey {
+    uint64_t hi;
+    uint64_t lo;
+    FormulaKey() : hi(0), lo(0) {}
+    bool operator==(const FormulaKey& other) const { return hi == other.hi && lo == other.lo; }
+    std::string hex() const {
+        char buf[33];
+        snprintf(buf, sizeof(buf), "%016llx%016llx", (unsigned long long)hi, (unsigned long long)lo);
+        return buf;
+    }
+};
+
+// Size of a normalised clause set, kept next to its key where a key match is trusted
+// as an answer (the result cache).
+struct FormulaShape {
+    uint64_t clauses;
+    uint64_t variables;
+    FormulaShape() : clauses(0), variables(0) {}
+    bool operator==(const FormulaShape& other) const { return clauses == other.clauses && variables == other.variables; }
+};
+
+// Canonical key of a clause set. Clauses are normalised (literals sorted, repeated
+// literals, tautologies and duplicate clauses removed) and sorted before hashing, so the
+// key depends on neither clause order nor literal order, and equivalent spellings of a
+// clause such as "1 1 2" and "2 1" get the same key.
+// Only the first count clauses are considered. If shape is given, it receives the number
+// of normalised clauses and of the distinct variables in them.
+template <typename Clauses>
+FormulaKey canonical_formula_key(const Clauses& clauses, size_t count = SIZE_MAX, FormulaShape* shape = nullptr) {
+    std::vector<std::vector<int>> normalised;
+    count = std::min(count, clauses.size());
+    normalised.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::vector<int> lits(clauses[i].begin(), clauses[i].end());
+        std::sort(lits.begin(), lits.end());
+        lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+        bool tautology = false;
+        for (int lit : lits)
+            if (lit > 0 && std::binary_search(lits.begin(), lits.end(), -lit))
+                tautology = true;
+        if (!tautology)
+            normalised.push_back(lits);
+    }
+    std::sort(normalised.begin(), normalised.end());
+    normalised.erase(std::unique(normalised.begin(), normalised.end()), normalised.end());
+
+    // Two independent FNV-1a style streams; a 0 separates clauses.
+    FormulaKey key;
+    key.hi = 1469598103934665603ULL;
+    key.lo = 0x84222325cbf29ce4ULL;
+    auto mix = [&key](uint32_t word) {
+        key.hi = (key.hi ^ word) * 1099511628211ULL;
+        key.lo = (key.lo ^ (word * 0x9e3779b9U)) * 0x100000001b3ULL + 0x9e3779b97f4a7c15ULL;
+    };
+    for (const auto& clause : normalised) {
+        for (int lit : clause)
+            mix((uint32_t)lit);
+        mix(0);
+    }
+    mix((uint32_t)normalised.size());
+    if (shape) {
+        std::vector<int> variables;
+        for (const auto& clause : normalised)
+            for (int lit : clause)
+                variables.push_back(std::abs(lit));
+        std::sort(variables.begin(), variables.end());
+        shape->clauses = normalised.size();
+        shape->variables = std::unique(variables.begin(), variables.end()) - variables.begin();
+    }
+    return key;
+}
+
+// Outcome of a solve that may stop early at a limit or on cancellation.
+enum class SolveStatus { Unsatisfiable, Satisfiable, Unknown };
+
+// Per-clause bookkeeping used by clause vivification and core tracking.
+struct ClauseInfo {
+    double activity;   // Bumped whenever the clause propagates or conflicts
+    bool vivified;     // Already vivified and unchanged since
+    int proof_id;      // Input clause number, or proof node of a learned clause (-1: none)
+    ClauseInfo() : activity(0.0), vivified(false), proof_id(-1) {}
+    explicit ClauseInfo(int id) : activity(0.0), vivified(false), proof_id(id) {}
+};
+
+//--------------------------------------------------------------
+// Huge-page memory and NUMA placement
+//--------------------------------------------------------------
+
+// Storage for the solver's large arrays (clause storage, per-literal arrays). An array
+// of at least one huge page is mapped on its own: from the reserved huge pages
+// (MAP_HUGETLB) when the kernel has some, otherwise as anonymous memory advised for
+// transparent huge pages, where the kernel supports them. Pages are not touched when
+// mapped, so each lands on the NUMA node of the thread that first writes it, the
+// worker building that solver. Smaller arrays, and all arrays where mmap is
+// unavailable, come from the heap. release() takes the size allocate() was given.
+SAT_API void* large_page_allocate(size_t bytes);
+SAT_API void large_page_release(void* p, size_t bytes);
+
+template <typename T>
+struct LargePageAllocator {
+    using value_type = T;
+
+    LargePageAllocator() {}
+    template <typename U>
+    LargePageAllocator(const LargePageAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(large_page_allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { large_page_release(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const LargePageAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const LargePageAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using large_vector = std::vector<T, LargePageAllocator<T>>;
+
+// Keep parallel worker number index on the CPUs of NUMA node index % nodes, so that the
+// memory its solver first touches stays local to it. Nothing to do on a single node.
+SAT_API void bind_worker_to_numa_node(size_t index);
+
+// One line on how the solver's large arrays were backed (peak bytes per backing) and
+// on NUMA placement; "" if every array was small enough for the heap.
+SAT_API std::string memory_backing_summary();
+
+// Resident memory of the process in KB, or -1 where it cannot be measured.
+SAT_API double get_memory_usage();
+
+// Literal storage for the clause database: every clause lives in one contiguous
+// region, addressed by clause index, instead of in a heap-allocated set of its own.
+// Literals are stored packed; clauses are read and written as signed literals, and
+// packed() gives the stored form to the search.
+// Shrinking or releasing a clause leaves a hole that is only counted; compact() slides
+// the surviving clauses down over the holes, in order, and reports where each came
+// from so that the caller can rewrite its references.
+class ClauseArena {
+public:
+    // Read-only view of one clause's literals.
+    struct Clause {
+        const unsigned* first;
+        const unsigned* last;
+        UnpackingIterator begin() const { return UnpackingIterator(first); }
+        UnpackingIterator end() const { return UnpackingIterator(last); }
+        PackedLiterals packed() const { return {first, last}; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    ClauseArena() : wasted(0) {}
+
+    size_t size() const { return starts.size(); }
+    size_t used_literals() const { return literals.size() - wasted; }
+    size_t free_literals() const { return wasted; }
+
+    Clause operator[](size_t idx) const {
+        const unsigned* first = literals.data() + starts[idx];
+        return Clause{first, first + lengths[idx]};
+    }
+
+    void reserve(size_t clauses, size_t literal_count) {
+        starts.reserve(clauses);
+        lengths.reserve(clauses);
+        literals.reserve(literal_count);
+    }
+
+    void clear() {
+        literals.clear();
+        starts.clear();
+        lengths.clear();
+        wasted = 0;
+    }
+
+    // Append a clause; its index is the old size().
+    template <typename Range>
+    void push_back(const Range& clause) {
+        starts.push_back(literals.size());
+        for (int lit : clause)
+            literals.push_back(packed_literal(lit));
+        lengths.push_back((uint32_t)(literals.size() - starts.back()));
+    }
+
+    // Overwrite clause idx in place; the new literals must not outnumber the old ones.
+    template <typename Range>
+    void shrink(size_t idx, const Range& clause) {
+        size_t length = std::distance(clause.begin(), clause.end());
+        if (length > lengths[idx])
+            throw std::logic_error("ClauseArena::shrink() cannot grow a clause.");
+        std::transform(clause.begin(), clause.end(), literals.begin() + starts[idx], packed_literal);
+        wasted += lengths[idx] - length;
+        lengths[idx] = (uint32_t)length;
+    }
+
+    // Sliding compaction. keep(idx, kept) is called for every clause in order; it fills
+    // kept with the literals the clause retains (at most its current ones) or returns
+    // false to delete the clause. source receives the old index of each surviving
+    // clause. Both buffers are the caller's, so that a sized caller does not allocate.
+    template <typename Keep>
+    void compact(Keep keep, std::vector<int>& source, std::vector<int>& kept) {
+        source.clear();
+        size_t write = 0, count = 0;
+        for (size_t idx = 0; idx < starts.size(); idx++) {
+            kept.clear();
+            if (!keep(idx, kept))
+                continue;
+            // The read position never lies below the write position, so the clause can
+            // be moved down directly.
+            std::transform(kept.begin(), kept.end(), literals.begin() + write, packed_literal);
+            starts[count] = write;
+            lengths[count] = (uint32_t)kept.size();
+            write += kept.size();
+            source.push_back((int)idx);
+            count++;
+        }
+        literals.resize(write);
+        starts.resize(count);
+        lengths.resize(count);
+        wasted = 0;
+    }
+
+private:
+    large_vector<unsigned> literals;
+    large_vector<size_t> starts;    // Offset of each clause in literals
+    large_vector<uint32_t> lengths;
+    size_t wasted;                  // Literals in holes left by shrink()
+};
+
+// The clauses as the search sees them: the literals of each clause that have not been
+// removed as false. A clause keeps all of its literals in one slot, the live ones
+// first; erase() swaps a literal behind the live part and insert() swaps it back, so
+// the search updates clauses in place and never allocates. Literals are stored packed,
+// as in ClauseArena; erase() and insert() take the packed form.
+class DynamicClauses {
+public:
+    // View of one clause's live literals.
+    class Clause {
+    public:
+        Clause(DynamicClauses* store, size_t idx) : store(store), idx(idx) {}
+        UnpackingIterator begin() const { return UnpackingIterator(first()); }
+        UnpackingIterator end() const { return UnpackingIterator(first() + store->live[idx]); }
+        PackedLiterals packed() const { return {first(), first() + store->live[idx]}; }
+        size_t size() const { return store->live[idx]; }
+        bool empty() const { return store->live[idx] == 0; }
+        bool count(int literal) const {
+            PackedLiterals live = packed();
+            return std::find(live.begin(), live.end(), packed_literal(literal)) != live.end();
+        }
+
+        void erase(unsigned packed) {
+            unsigned* first = store->literals.data() + store->starts[idx];
+            unsigned* last = first + store->live[idx];
+            unsigned* found = std::find(first, last, packed);
+            if (found != last) {
+                std::swap(*found, *(last - 1));
+                store->live[idx]--;
+            }
+        }
+
+        // Make a literal of the clause live again; a literal the clause never had is ignored.
+        void insert(unsigned packed) {
+            unsigned* first = store->literals.data() + store->starts[idx];
+            unsigned* live_end = first + store->live[idx];
+            unsigned* found = std::find(live_end, first + store->lengths[idx], packed);
+            if (found != first + store->lengths[idx]) {
+                std::swap(*found, *live_end);
+                store->live[idx]++;
+            }
+        }
+
+    private:
+        DynamicClauses* store;
+        size_t idx;
+
+        const unsigned* first() const { return store->literals.data() + store->starts[idx]; }
+    };
+
+    size_t size() const { return starts.size(); }
+    size_t literal_count() const { return literals.size(); }
+    Clause operator[](size_t idx) { return Clause(this, idx); }
+    const Clause operator[](size_t idx) const { return Clause(const_cast<DynamicClauses*>(this), idx); }
+
+    void reserve(size_t clauses, size_t literal_count) {
+        starts.reserve(clauses);
+        lengths.reserve(clauses);
+        live.reserve(clauses);
+        literals.reserve(literal_count);
+    }
+
+    void clear() {
+        literals.clear();
+        starts.clear();
+        lengths.clear();
+        live.clear();
+    }
+
+    // Append a clause with all of its literals live.
+    template <typename Range>
+    void push_back(const Range& clause) {
+        emplace_back(clause.begin(), clause.end());
+    }
+
+    template <typename Iterator>
+    void emplace_back(Iterator first, Iterator last) {
+        starts.push_back(literals.size());
+        for (; first != last; ++first)
+            literals.push_back(packed_literal(*first));
+        lengths.push_back((uint32_t)(literals.size() - starts.back()));
+        live.push_back(lengths.back());
+    }
+
+    // Replace clause idx by fewer literals, all live; the others are gone for good.
+    template <typename Range>
+    void shrink(size_t idx, const Range& clause) {
+        size_t length = std::distance(clause.begin(), clause.end());
+        if (length > lengths[idx])
+            throw std::logic_error("DynamicClauses::shrink() cannot grow a clause.");
+        std::transform(clause.begin(), clause.end(), literals.begin() + starts[idx], packed_literal);
+        lengths[idx] = live[idx] = (uint32_t)length;
+    }
+
+private:
+    large_vector<unsigned> literals;
+    large_vector<size_t> starts;    // Offset of each clause in literals
+    large_vector<uint32_t> lengths; // Literals in the slot
+    large_vector<uint32_t> live;    // Of which the first live[idx] are live
+};
+
+// Set of clause indices with constant-time insert, erase and lookup and iteration over
+// a dense array: the members, and each clause's position among them (-1 if absent).
+// Erasing moves the last member into the hole, so erase only outside an iteration.
+class ClauseIndexSet {
+public:
+    bool count(int idx) const { return (size_t)idx < position.size() && position[idx] >= 0; }
+    size_t size() const { return members.size(); }
+    bool empty() const { return members.empty(); }
+    const int* begin() const { return members.data(); }
+    const int* end() const { return members.data() + members.size(); }
+
+    // Room for clause indices below clauses, so that insert() does not allocate.
+    void reserve(size_t clauses) {
+        members.reserve(clauses);
+        if (position.size() < clauses)
+            position.resize(clauses, -1);
+    }
+
+    void insert(int idx) {
+        if ((size_t)idx >= position.size())
+            position.resize(std::max<size_t>(idx + 1, 2 * position.size()), -1);
+        if (position[idx] >= 0)
+            return;
+        position[idx] = (int)members.size();
+        members.push_back(idx);
+    }
+
+    void erase(int idx) {
+        if (!count(idx))
+            return;
+        int last = members.back();
+        members[position[idx]] = last;
+        position[last] = position[idx];
+        members.pop_back();
+        position[idx] = -1;
+    }
+
+    void clear() {
+        for (int idx : members)
+            position[idx] = -1;
+        members.clear();
+    }
+
+private:
+    large_vector<int> members;
+    large_vector<int> position;
+};
+
+// Search traces (satsolver.cpp).
+class TraceWriter;
+class TraceReader;
+
+class SAT_API DPLLSolver_DS {
+public:
+    // Data members
+    DynamicClauses cnf;                          // Dynamic CNF (clauses updated during search)
+    ClauseArena original_cnf;                    // Original CNF (learned clauses added here)
+    // Variable state as separate dense arrays. Arrays indexed by packed literal have two
+    // slots per variable; slots 0 and 1 are unused.
+    int num_vars;
+    large_vector<int8_t> lit_value;              // Per packed literal: 1 true, 0 false, -1 unassigned
+    large_vector<std::vector<int>> occurrences;  // Per packed literal: clauses containing it
+    large_vector<double> lit_activity;           // Per packed literal: VSIDS conflict counter
+    large_vector<int8_t> saved_phase;            // Per variable: last value before unassignment (-1: never assigned)
+    std::vector<int> assignments_stack;          // Stack of current assignments (literals)
+    std::vector<std::vector<int>> amo_groups;    // At-most-one constraints that replaced pairwise binary clauses
+    std::vector<std::vector<int>> amo_occurrences; // Per packed literal: groups containing it
+    std::vector<int> amo_queue;                  // Members made true whose groups are not forced yet
+    bool amo_extracted;
+    ClauseIndexSet unsatisfied_clauses;          // Set of clause indices that are not yet satisfied
+
+    AssignmentStatus last_assignment_status;
+
+    // Scratch buffers of the search, sized by reserve_search_buffers() so that the
+    // search loop does not allocate.
+    std::vector<int> unit_scratch;               // Unit clauses found by a scan in dpll()
+    std::vector<int> pure_scratch;               // Pure literals found by find_pure_literals()
+    large_vector<double> literal_tally;          // Per packed literal: a count, 0 between uses
+    std::vector<int> tallied_literals;           // Literals whose tally is in use
+    std::vector<int> lookahead_scratch;          // Lookahead candidates
+    std::vector<std::pair<double, int>> ranked_scratch; // Lookahead candidates by weight
+    std::vector<int> probe_trail;                // Assignments of the current lookahead probe
+    std::vector<size_t> probe_marks;             // Nested probes of a replayed lookahead
+    std::vector<int> cube_scratch;               // Model reported during enumeration
+    std::vector<int> trail_now, trail_then;      // Compared by resumes_at()
+    std::vector<int> clause_scratch;             // Clause indices: reduction and vivification candidates
+    std::vector<char> drop_marks;                // Per clause: removed by the next simplify_root()
+    std::vector<int> compact_source, compact_kept; // Buffers of ClauseArena::compact()
+    std::vector<ClauseInfo> info_scratch;        // Swapped with clause_info by reload_clauses()
+    std::vector<int> vivify_literals, vivify_kept;
+    std::vector<int> probe_stamp;                // Per packed literal: last probe that implied it
+    std::vector<int> necessary_scratch;
+    std::vector<int> implication_start, implication_edges; // Binary implication graph of substitution
+    std::vector<int> tarjan_index, tarjan_lowlink, scc_component, scc_scratch, substitute_scratch;
+    std::vector<char> scc_on_stack;
+    std::vector<std::pair<int, size_t>> tarjan_calls;
+
+    int max_learned_clause_len;
+    int max_learned_clauses;
+    int learned_clauses_count;
+    long long dropped_learned_clauses;           // Learned clauses not kept: an occurrence list was full
+    bool occurrences_full;                       // A list ran out of headroom since the last restart
+    size_t occurrence_headroom;                  // Room reserve_search_buffers() leaves in each occurrence list
+    double decay_factor;
+    double conflict_weight;
+    int decay_interval;
+    int decision_count;
+
+    int num_original_clauses;                    // Clauses [0, num_original_clauses) come from the input
+    bool root_conflict;                          // Set once root-level simplification derives the empty clause
+    std::vector<int> root_trail;                 // Literals fixed at the root by inprocessing
+    std::vector<std::pair<int, int>> eliminated; // (variable, literal) pairs removed by equivalent-literal substitution
+    long long probe_budget;                      // Clause visits allowed per failed-literal probing round
+    long long propagation_visits;                // Clause visits performed by propagate()
+
+    std::vector<ClauseInfo> clause_info;         // Parallel to cnf
+    long long conflicts;
+    int restarts;
+    int restart_base;                            // Conflicts before the first restart
+    double restart_growth;                       // Factor applied to the restart interval after each restart
+    long long next_restart;                      // Conflict count at which the next restart is due
+    bool restart_pending;                        // Set when the search should unwind to the root
+    double inprocess_effort;                     // Inprocessing time allowed as a fraction of search time
+    double search_seconds;
+    double inprocess_seconds;
+    int vivify_cursor;                           // Next original clause to vivify (round robin)
+
+    FormulaKey formula_key;                      // canonical_formula_key() of the input clauses, once computed
+    FormulaShape formula_shape;                  // Their normalised size, computed with the key
+    bool formula_key_ready;
+    std::string snapshot_path;                   // Where periodic snapshots are written (empty: disabled)
+    double snapshot_interval;                    // Seconds between snapshots
+    std::chrono::steady_clock::time_point last_snapshot;
+    bool use_saved_phases;                       // Decide with the phases restored from a snapshot
+    bool use_lookahead;                          // Decide by lookahead instead of VSIDS counts
+    bool decompose;                              // Solve independent components separately
+    int components_solved;                       // Components of the last solve (0: did not split)
+    unsigned component_workers;                  // Threads that solve the components (0: one per core)
+    bool reorder;                                // Renumber for locality when the first solve starts
+    bool order_fixed;                            // A solve has started: the numbering is final
+    std::vector<int> input_var;                  // Per variable: its number in the input (empty: not renumbered)
+    std::vector<int> solver_var;                 // Per input variable: its number here (empty: not renumbered)
+
+    long long conflict_limit;                    // Stop after this many conflicts (-1: no limit)
+    std::atomic<long long>* shared_conflicts;    // Budget shared with solvers on other threads (null: none)
+    bool holds_shared_conflict;                  // One conflict of it is taken ahead for the next conflict
+    long long assignment_count;                  // Assignments made by assign()
+    long long assignment_limit;                  // Stop after this many assignments (-1: no limit)
+    bool stepping;                               // step() has simplified the root
+    SolveStatus step_status;                     // Answer found by step(), once known
+    struct OpenDecision {
+        size_t trail_position;                   // Index of the decision in assignments_stack
+        int literal;                             // Literal assigned
+        bool second_branch;                      // The other polarity is already refuted
+    };
+    std::vector<OpenDecision> open_decisions;    // Decisions on the current search path
+    std::vector<OpenDecision> resume_decisions;  // Path an interrupted step() resumes along
+    std::vector<int> resume_trail;               // assignments_stack when that step stopped
+    std::unique_ptr<TraceWriter> trace_out;      // Recording of the search (null: off)
+    std::unique_ptr<TraceReader> trace_in;       // Trace being replayed (null: off, finished or diverged)
+    long long traced_events;                     // Events of the replayed trace the search followed
+    std::string replay_divergence;               // Where the replay left the trace ("" if it did not)
+    bool has_deadline;
+    std::chrono::steady_clock::time_point deadline; // Stop at this time if has_deadline
+    const std::atomic<bool>* cancel_flag;        // Stop when set by another thread (may be null)
+    bool aborted;                                // The last solve stopped at a limit
+    int limit_check_counter;
+
+    bool enumerating;                            // enumerate() is running: models do not end the search
+    bool completing;                             // Looking for any extension of a decided projection
+    std::vector<char> projected;                 // Per variable: part of the enumeration projection
+    std::function<bool(const std::vector<int>&, int)> model_report;
+
+    int learned_clause_limit_percentage;
+    long long input_literals;                    // Literals in the clauses added so far
+    std::vector<int> input_units;                // Unit clauses seen while loading
+    std::unordered_map<uint64_t, int> loaded_clauses; // Hash of each sorted input clause -> index, for duplicate detection
+
+    // UNSAT core tracking (track_core()). Proof ids 0..input_clauses-1 are the input
+    // clauses in add_clause() order; id input_clauses + j is the j-th learned clause,
+    // whose proof node lists the two clauses it was resolved from. The clauses the
+    // search uses to propagate and to conflict are recorded by proof id, at the root
+    // and in the current search episode; a refuting episode and the root together
+    // derive the empty clause from the input clauses their proof nodes reach.
+    int input_clauses;                           // add_clause() calls so far
+    size_t longest_clause;                       // Upper bound on the length of any clause
+    std::vector<int> input_unit_ids;             // Proof ids of input_units
+    bool core_tracking;
+    ClauseArena tracked_inputs;                  // Every input clause by proof id, while tracking
+    int empty_clause_id;                         // An empty input clause (-1: none)
+    std::vector<size_t> proof_start;             // Per proof node: its first parent in proof_parents
+    std::vector<int> proof_parents;
+    std::vector<uint32_t> core_mark;             // Per proof id: 1 used at the root, else the episode that used it
+    uint32_t core_scope;                         // Mark of the current uses: 1 at the root
+    uint32_t core_episodes;
+    std::vector<int> root_uses;                  // Proof ids used at the root
+    std::vector<int> episode_uses;               // Proof ids used by the current search episode
+
+    // Constructor: cnf_clauses is a vector of clauses (each clause is a set of literals)
+    DPLLSolver_DS(const std::vector<std::unordered_set<int>>& cnf_clauses,
+                  int learned_clause_limit_percentage = 25,
+                  int max_learned_clause_len_param = 5);
+
+    // Constructor for incremental loading: add the input with add_clause(), then call
+    // finish_loading() before solving.
+    explicit DPLLSolver_DS(int learned_clause_limit_percentage_param = 25,
+                           int max_learned_clause_len_param = 5);
+
+    ~DPLLSolver_DS();
+
+    // Add one input clause, building its occurrence lists on the fly. Tautologies and
+    // duplicate clauses are dropped; unit clauses are remembered for root propagation.
+    void add_clause(const int* begin, const int* end);
+
+    // Pre-size the clause storage, e.g. from the "p cnf" header.
+    void reserve_clauses(size_t count);
+
+    // Make sure variables 1..count exist, including ones the header declares but no clause uses.
+    void declare_variables(long long count);
+
+    int num_variables() const { return num_vars; }
+
+    // Value of a literal: 1 true, 0 false, -1 unassigned.
+    int value_of(int literal) const;
+
+    // Complete incremental loading: size the learned-clause cap and probing budget.
+    void finish_loading();
+
+    // Adopt a key computed elsewhere (e.g. stored in a binary CNF file).
+    void set_formula_key(const FormulaKey& key, const FormulaShape& shape);
+
+    // Canonical key of the input formula. Computed on first use, which must happen
+    // before solve() starts simplifying the clause database.
+    const FormulaKey& get_formula_key();
+
+    // Normalised clause and variable counts of the input formula, from the same pass.
+    const FormulaShape& get_formula_shape();
+
+    // Public solve method. The search restarts on a geometric schedule; between restarts
+    // the clause database is simplified and vivified at the root. The learned-clause cap
+    // keeps the gain of a restart small, so restarts are kept sparse.
+    bool solve();
+
+    // Choose the decision heuristic: VSIDS literal counts (default) or lookahead, which
+    // is stronger on small hard random instances.
+    void set_lookahead(bool enabled);
+
+    // Names of the search parameters set_parameter() accepts, in configuration-file order.
+    static const std::vector<std::string>& parameter_names();
+
+    // Set a search parameter by name. Returns false for an unknown name or a value out
+    // of range, leaving the solver unchanged. May be called before or after loading.
+    bool set_parameter(const std::string& name, double value);
+
+    // Current value of a parameter listed by parameter_names().
+    double get_parameter(const std::string& name) const;
+
+    // Cheap syntactic features of the input clauses, for algorithm selection: size and
+    // clause/variable ratio, clause-length histogram, polarity balance, and statistics
+    // of the graph whose edges are the binary clauses. One pass over the literals; call
+    // after loading and before solving.
+    std::vector<std::pair<std::string, double>> instance_features() const;
+
+    // Bound the next solve: a conflict budget (-1 for none), a wall-clock budget in
+    // seconds (<= 0 for none) and an optional flag another thread sets to cancel.
+    void set_limits(long long max_conflicts, double max_seconds, const std::atomic<bool>* cancel = nullptr);
+
+    // Threads that solve the components of a formula that splits (0, the default: one per
+    // hardware thread).
+    void set_component_workers(unsigned workers) { component_workers = workers; }
+
+    // Solve within the limits given to set_limits(); Unknown if a limit stopped the search.
+    SolveStatus solve_limited();
+
+    // Record the search to a trace file (see TraceWriter); call before solving.
+    void record_trace(const std::string& path);
+
+    // Replay a trace recorded for the same formula: the decisions, and the literals a
+    // failed lookahead forced, are taken from it instead of from the heuristics, and
+    // vivification between restarts does the recorded amount of work instead of using
+    // its time budget. Conflicts, learned clauses and restarts are checked against the
+    // trace; at the first mismatch the replay stops and the heuristics take over.
+    void replay_trace(const std::string& path);
+
+    // One line on the recording or replay of the last solve ("" if neither ran).
+    std::string trace_summary() const;
+
+    // Resumable solving for cooperative multiplexing: run the search on the calling
+    // thread for at most max_conflicts conflicts and max_assignments assignments (-1:
+    // no bound) and return. Unknown means the budget ran out; the next call re-enters the
+    // decisions that were open, skipping branches already refuted, and goes on from there
+    // with everything learned so far. Once the answer is known, further calls return it.
+    // Root simplification runs on the first step only and the formula is not decomposed;
+    // a deadline or cancel flag from set_limits() still applies.
+    SolveStatus step(long long max_conflicts, long long max_assignments = -1);
+
+    long long assignments() const { return assignment_count; }
+
+    // Enumerate all models in one search, without restarts or blocking clauses: once a model
+    // is reported the search backtracks chronologically as after a conflict, so the branches
+    // explored are disjoint. Each model is reported as a cube, report(cube, free): cube holds
+    // the assigned literals over the projection (all variables if projection is empty), and
+    // free counts the projected variables left open, each of which may take either value.
+    // With a projection, projected variables are decided first and each projected cube is
+    // reported once, as soon as any extension of it is found. report returns false to stop.
+    // Returns true if the enumeration is complete, false if a limit or report stopped it.
+    bool enumerate(const std::vector<int>& projection, std::function<bool(const std::vector<int>&, int)> report);
+
+    // Write periodic snapshots to path every interval_seconds while solving.
+    void enable_snapshots(const std::string& path, double interval_seconds);
+
+    // Write the learned clauses, root units, VSIDS counters and saved phases to path.
+    // The file is written next to path and renamed over it, so a kill mid-write leaves
+    // the previous snapshot intact.
+    // Layout (little-endian): "SATSNAP1", u32 version, u32 variables, u64 key hi,
+    // u64 key lo (the formula key), u64 conflicts, then per variable f64 pos_count, f64 neg_count, i8 phase, then
+    // u32 clause count and per clause u32 length followed by i32 literals.
+    bool save_snapshot(const std::string& path);
+
+    // Restore a snapshot written by save_snapshot() for the same formula. Must be called
+    // before solve(). Throws if the file is malformed or belongs to another formula.
+    void load_snapshot(const std::string& path);
+
+    // Number of an input variable inside the solver; the two differ after renumbering.
+    int solver_variable(int var) const;
+
+    // Value of an input variable: 1 true, 0 false, -1 unassigned.
+    int input_value(int var) const;
+
+    // Current assignments as literals in input variable order (unassigned variables omitted).
+    std::vector<int> get_model() const;
+
+    // Print assignments in sorted order of the input variables.
+    void print_assignments();
+
+    // Get current assignments as a map, keyed by input variable.
+    std::unordered_map<int, int> get_assignments();
+
+    // Record clause provenance so that unsat_core() can name the input clauses behind an
+    // unsatisfiable answer. Call before adding clauses. Simplifications that rewrite
+    // clauses without a proof (at-most-one groups, equivalent literals, failed-literal
+    // probing, vivification, renumbering, components) are skipped while tracking.
+    void track_core();
+
+    // After an unsatisfiable solve with core tracking: input clauses, numbered from 0 in
+    // add_clause() order, whose conjunction is unsatisfiable. Sorted.
+    std::vector<int> unsat_core() const;
+
+    int input_clause_count() const { return input_clauses; }
+
+    // Input clause id as added (sorted, without repeated literals), while tracking.
+    ClauseArena::Clause input_clause(int id) const { return tracked_inputs[id]; }
+
+    // Clauses this solver derived, each with the input clauses it follows from: the
+    // literals fixed at the root and the learned clauses in their root-simplified form,
+    // which both rest on the root derivation. A solve over a subset of the input can
+    // take the ones whose inputs it has (add_derived_clause()).
+    std::vector<std::pair<std::vector<int>, std::vector<int>>> derived_clauses() const;
+
+    // Add a clause implied by the given input clauses (ids of this solver), after
+    // finish_loading() and before solving. It joins as a learned clause regardless of
+    // the learned-clause cap, like the clauses of a snapshot.
+    void add_derived_clause(const std::vector<int>& lits, const std::vector<int>& inputs);
+
+private:
+    static constexpr const char* SNAPSHOT_MAGIC = "SATSNAP1";
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+    template <typename T>
+    static void write_pod(std::ofstream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static void read_pod(std::ifstream& in, T& value) {
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+
+    // The search loop behind solve_limited() and step(): search, restarting and
+    // inprocessing as scheduled, until an answer or a limit.
+    SolveStatus search();
+
+    // Propagate the input units and run the root-level inprocessing; false if the formula
+    // is unsatisfiable at the root.
+    bool prepare_root();
+
+    // Every clause is satisfied. A normal solve stops here; during enumeration the model is
+    // reported and the search goes on, so the caller backtracks as after a conflict.
+    bool model_found();
+
+    void report_model();
+
+    // Literals the enumeration must not fix by pure-literal elimination: dropping the other
+    // polarity of a projected variable would lose models.
+    bool keeps_all_polarities(int literal) const;
+
+    // Whether the search can re-enter resume_decisions[depth]: the assignments made since
+    // the decision above it (propagation, pure literals) must be the same as when the
+    // interrupted step made it, or its refuted branches may not be refuted here.
+    bool resumes_at(size_t depth);
+
+    // The main recursive DPLL algorithm.
+    bool dpll();
+
+    // Find pure literals that appear with only one polarity, in pure_scratch.
+    std::vector<int>& find_pure_literals();
+
+    // Add weight to a literal's (or variable's) entry of literal_tally.
+    void tally(int literal, double weight);
+
+    void clear_tally();
+
+    //--------------------------------------------------------------
+    // Lookahead decisions
+    //--------------------------------------------------------------
+
+    // Look ahead on a preselected set of candidate variables: propagate each polarity,
+    // score how much it shrinks the unsatisfied clauses, and branch on the variable whose
+    // two polarities both shrink the formula most. A polarity whose propagation conflicts
+    // is a failed literal; its negation is forced at this node (on assignments_stack) and
+    // the lookahead goes on. Returns false if both polarities of a variable fail, i.e.
+    // the node is a conflict; otherwise branch_lit is the decision (0 if no candidate).
+    bool lookahead(int& branch_lit);
+
+    // Free variables ranked by their occurrences in short unsatisfied clauses; at most
+    // 10% of the free variables, between 8 and 40 of them.
+    const std::vector<int>& lookahead_candidates();
+
+    // Weighted count of the unsatisfied clauses the assignments on trail shortened:
+    // a clause cut down to two literals counts most.
+    double reduction_score(const std::vector<int>& trail);
+
+    // Double lookahead only pays off after a lookahead that created many short clauses.
+    double double_lookahead_threshold() const;
+
+    // Under the lookahead on var (propagated on trail), check the other candidates for
+    // literals that fail in both polarities; one such variable proves the lookahead
+    // literal failed. Returns false in that case.
+    bool double_lookahead(const std::vector<int>& candidates, int var, std::vector<int>& trail);
+
+    bool projection_is_partial() const;
+
+    // VSIDS: select the most frequently occurring unassigned literal, optionally only
+    // among the projected variables.
+    int vsids_frequent_literal(bool projected_only = false);
+
+    // Try to assign a literal and update affected clauses.
+    bool assign(int literal);
+
+    // Revert the assignment of a literal and restore the affected clauses.
+    void unassign(int literal);
+
+    // Check if a clause is satisfied.
+    bool is_clause_satisfied(int clause_index);
+
+    // Record that clause idx propagated or conflicted (core tracking).
+    void use_clause(int idx);
+
+    void use_proof_id(int id);
+
+    // New proof node whose parents are the proof ids [first, last); returns its id.
+    int add_proof_node(const int* first, const int* last);
+
+    // Input ids reachable through the proof nodes from the given proof ids, sorted.
+    std::vector<int> proof_inputs(const std::vector<int>& uses) const;
+
+    // Add the learned clause of a conflict, the resolvent of its two clauses.
+    void add_learned_clause(const AssignmentStatus& conflict);
+
+    //--------------------------------------------------------------
+    // At-most-one constraints
+    //--------------------------------------------------------------
+
+    // Replace cliques of the graph whose edges are the binary clauses (-a | -b), i.e.
+    // "at most one of a and b", by native at-most-one groups. Greedy: from each literal,
+    // in order of decreasing degree, grow a clique out of neighbours whose edges to
+    // every member are not yet covered by a group; a clique of three or more literals
+    // replaces its k(k-1)/2 clauses. A variable joins groups with one polarity only.
+    // Runs once, at the root. Returns false if the simplified formula is unsatisfiable.
+    bool extract_at_most_one();
+
+    bool in_at_most_one(int var) const;
+
+    // Make every other member of the groups of a true literal false, for the literals
+    // queued by assign(), and propagate on assignments_stack. The removed binary clauses
+    // no longer let assign() see the conflicts these literals cause, so propagate()
+    // checks the clauses they falsify. Returns false on a conflict.
+    bool force_at_most_one();
+
+    //--------------------------------------------------------------
+    // Root-level inprocessing: failed literals and equivalent literals
+    //--------------------------------------------------------------
+
+    // Run root-level simplification, equivalent-literal substitution and failed-literal
+    // probing. Must be called with no decisions on the stack. Returns false if the
+    // formula is found unsatisfiable.
+    bool inprocess();
+
+    // Rebuild the clause database from original_cnf under the root assignment and
+    // propagate the unit clauses that remain, until no unit clause is left.
+    // Clauses flagged in drop are removed from the database. The clause arena is
+    // compacted in the same pass, which reclaims the space of every removed clause.
+    bool simplify_root(const std::vector<char>& drop = {});
+
+    // Rebuild the search state after original_cnf was compacted. source[i] is the index
+    // the i-th clause had before; it keeps the clause's original/learned status and its
+    // ClauseInfo.
+    void reload_clauses(const std::vector<int>& source);
+
+    // Assign a literal and propagate unit clauses through the occurrence lists.
+    // Every assignment made is appended to trail (even the conflicting one) so that
+    // backtrack_to() can restore the clauses touched by assign(). Returns false on conflict.
+    bool propagate(int literal, std::vector<int>& trail);
+
+    // Assign a single literal on behalf of propagate().
+    bool enqueue(int literal, std::vector<int>& trail);
+
+    // Undo the assignments on trail above the given size. The members they queued for
+    // force_at_most_one() are the newest entries of amo_queue; drop them with them, or
+    // the probes of lookahead() would keep growing the queue.
+    void backtrack_to(std::vector<int>& trail, size_t size);
+
+    // Probe both polarities of every unassigned variable. A literal whose propagation
+    // conflicts is failed and its negation is fixed at the root; literals implied by
+    // both polarities are necessary assignments and are fixed as well.
+    bool probe_failed_literals();
+
+    // Find the strongly connected components of the binary implication graph and
+    // substitute every literal by the representative of its component.
+    bool substitute_equivalent_literals();
+
+    // Complete the model: set the members of at-most-one groups left open to false, then
+    // give the variables removed by substitution the value of their representative, in
+    // reverse order of elimination so that chained substitutions resolve correctly.
+    void extend_model();
+
+    //--------------------------------------------------------------
+    // Component decomposition
+    //--------------------------------------------------------------
+
+    // Split the root-simplified formula into components that share no variable
+    // (union-find over the variables of each open clause and at-most-one group) and,
+    // if there are several, solve each in its own solver on a thread pool. Component
+    // solvers get the open clauses renumbered to their own variables, with groups
+    // written back as pairwise clauses for them to detect again, and share the time and
+    // conflict budget; one unsatisfiable component cancels the others. Returns false,
+    // leaving the search untouched, if the formula does not split; otherwise sets
+    // status and, when satisfiable, merges the component models into the assignment.
+    bool solve_components(SolveStatus& status);
+
+    // The conflict budget of solvers running on several threads. A solver takes each
+    // conflict from the pool before it happens, one ahead, and stops when the pool is
+    // empty, so that together they never exceed it. share_conflict_budget() takes the
+    // first (false if there is none); release_shared_conflicts() gives back the one held
+    // when the solve ends for another reason.
+    bool share_conflict_budget(std::atomic<long long>* budget);
+    void release_shared_conflicts();
+    bool take_shared_conflict();
+
+    //--------------------------------------------------------------
+    // Restarts and clause vivification
+    //--------------------------------------------------------------
+
+    // Count a conflict and request a restart once the current interval is used up.
+    void note_conflict();
+
+    // Stop the search once a limit is reached or cancellation is requested; the search
+    // unwinds through the restart path and solve_limited() reports Unknown.
+    void check_limits();
+
+    // Root-level work run after each restart, capped at inprocess_effort of the search time.
+    bool inprocess_between_restarts();
+
+    // Record an event of the search, and when replaying, check it against the trace.
+    void trace(char tag, uint64_t value = 0);
+
+    // Stop replaying: the search reached reached_event where the trace has something else.
+    void diverge(const std::string& reached_event);
+
+    // Re-execute a node's lookahead from the trace: redo its probes (their propagation
+    // and undoing leave the clause sets as the recorded run had them) and propagate the
+    // literals it forced, then take the decision. False on a conflict, as lookahead()
+    // would return. replayed is set if the decision came from the trace; if the trace
+    // does not fit the node, the replay stops and the heuristics decide.
+    bool replay_decision(int& branch_lit, bool& replayed);
+
+    // Once the learned-clause cap is reached, forget the less active half of the learned
+    // clauses so that learning can go on; simplify_root() reclaims their space.
+    bool reduce_learned_clauses();
+
+    // Vivify the most active learned clauses and a round-robin slice of the original
+    // clauses until the deadline, or max_clauses of them (-1: no count limit), then drop
+    // the clauses shown redundant. vivified is set to the number of clauses processed.
+    bool vivify_clauses(std::chrono::steady_clock::time_point deadline, long long max_clauses, size_t& vivified);
+
+    // Propagate the negations of the clause's literals with the clause itself detached.
+    // A conflict, or a clause literal implied true or false, yields a shorter clause
+    // implied by the rest of the database. Redundant learned clauses are dropped.
+    void vivify_clause(int idx, std::vector<char>& drop);
+
+    // Remove a clause from the occurrence lists and the unsatisfied set.
+    void detach_clause(int idx);
+
+    // Add a clause back to the occurrence lists; only valid at the root, where every
+    // literal of the clause is unassigned.
+    void attach_clause(int idx);
+
+    // Decay the conflict counters.
+    void decay_counters();
+
+    // Boost the counters for conflict literals.
+    void boost_conflict_literals(const std::vector<int>& conflict_clause);
+
+    // Size the stacks and scratch buffers of the search and of the inprocessing between
+    // restarts, and leave room in the clause stores for as many learned clauses as the
+    // cap allows, so that the search loop that follows does not allocate. The clause
+    // count never exceeds the input clauses plus the cap, and compaction only shrinks.
+    void reserve_search_buffers();
+
+    // Room in the proof record for the nodes one search episode can add: one per learned
+    // clause, with its two parents. The record keeps every node of the run, so unlike the
+    // other buffers it is extended before each episode, outside the allocation count.
+    void reserve_proof_nodes();
+
+    // Room in the occurrence lists that filled up during the last search episode. Until
+    // the next restart a learned clause with a literal whose list is full is dropped
+    // (and counted) rather than grown into, which would allocate in the search loop.
+    void regrow_occurrence_lists();
+
+    // Input form of a solver literal.
+    int input_literal(int literal) const;
+
+    // Called as a solve starts: renumber if asked to, then keep the numbering.
+    void fix_variable_order();
+
+    // Renumber the variables for cache locality. The order is Cuthill-McKee on the
+    // variable-interaction graph: breadth-first from a least-connected variable, where
+    // each clause is expanded once and the variables it adds are numbered by increasing
+    // degree. Variables that share clauses then sit close together in the per-literal
+    // arrays, and sorting the clauses by their first variable gives the clauses in one
+    // occurrence list nearby indices in the arena. Runs before the first solve, when
+    // only the input clauses and any snapshot clauses (kept as learned) exist.
+    void renumber_for_locality();
+
+    // Grow the variable arrays to hold variables 1..count.
+    void resize_variables(int count);
+};
+
+// Read-only view of a whole file: memory-mapped where available, read into a buffer
+// otherwise.
+class SAT_API MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Hint the kernel about the access pattern (no-op without mmap).
+    void advise_sequential() const;
+
+private:
+    const char* bytes;
+    size_t length;
+    bool mapped;
+    std::vector<char> buffer;   // Backing store where mmap is unavailable
+};
+
+// Parsed clauses in flat form: clause i is literals[offsets[i], offsets[i + 1]).
+struct ParsedCnf {
+    std::vector<int> literals;
+    std::vector<size_t> offsets;
+    long long header_vars;          // From the "p cnf" line, -1 if absent
+    long long header_clauses;
+    int max_var;
+    ParsedCnf() : offsets(1, 0), header_vars(-1), header_clauses(-1), max_var(0) {}
+
+    size_t clauses() const { return offsets.size() - 1; }
+
+    std::vector<std::unordered_set<int>> to_clauses() const {
+        std::vector<std::unordered_set<int>> result(clauses());
+        for (size_t i = 0; i < clauses(); i++)
+            result[i].insert(literals.begin() + offsets[i], literals.begin() + offsets[i + 1]);
+        return result;
+    }
+};
+
+// Chunked DIMACS parser. The file is split at line boundaries into chunks that are
+// tokenised independently on worker threads; because tokens never straddle a line,
+// concatenating the chunks' token streams in order reproduces the file's stream, and a
+// clause spanning two chunks is stitched together when the chunks are combined.
+class SAT_API ChunkedDimacsParser {
+public:
+    // One chunk's tokens: literals without terminators, plus the local literal count at
+    // each terminating 0.
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<int> literals;
+        std::vector<size_t> ends;
+        bool leading_zero;          // The first 0 had no literal before it in this chunk
+        bool stop;                  // A '%' line ends the data (SATLIB convention)
+        long long header_vars;
+        long long header_clauses;
+        int max_var;
+        std::string error;
+        Chunk() : begin(nullptr), end(nullptr), leading_zero(false), stop(false),
+                  header_vars(-1), header_clauses(-1), max_var(0) {}
+    };
+
+    ChunkedDimacsParser(const std::string& filename, unsigned threads);
+
+    // Parse DIMACS text already in memory; the text must outlive the parser.
+    ChunkedDimacsParser(const char* text, size_t length, unsigned threads);
+
+    // Tokenise all chunks on the worker threads. consume(chunk, first_clause_begins)
+    // is called on the calling thread for each chunk in file order as soon as it and
+    // all earlier chunks are parsed, so the caller can overlap its own work with the
+    // parsing of later chunks.
+    template <typename Consume>
+    void run(Consume consume) {
+        std::vector<std::thread> pool;
+        unsigned spawn = (chunks.size() > 1 ? std::min<unsigned>(workers, (unsigned)chunks.size()) : 0);
+        for (unsigned t = 0; t < spawn; t++)
+            pool.emplace_back([this] { work(); });
+        if (spawn == 0)
+            work();
+        try {
+            for (size_t i = 0; i < chunks.size(); i++) {
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    chunk_done.wait(lock, [this, i] { return done[i] != 0; });
+                }
+                if (!chunks[i].error.empty())
+                    throw std::runtime_error(chunks[i].error);
+                consume(chunks[i]);
+                if (chunks[i].stop) {
+                    next_chunk = chunks.size();
+                    break;
+                }
+            }
+        } catch (...) {
+            next_chunk = chunks.size();     // Let the workers finish early.
+            for (auto& t : pool)
+                t.join();
+            throw;
+        }
+        for (auto& t : pool)
+            t.join();
+    }
+
+    // Parse the whole file into flat storage. Chunk sizes are combined with a prefix sum
+    // and the chunks are copied into place in parallel, preserving clause order.
+    ParsedCnf parse_all();
+
+    // Record the header and the largest variable of a consumed chunk.
+    static void note_header(ParsedCnf& result, const Chunk& chunk);
+
+    // Check the parsed clauses against the "p cnf" line, if there was one.
+    static void validate_header(const ParsedCnf& result);
+
+private:
+    std::unique_ptr<MappedFile> file; // Null when parsing text supplied in memory
+    unsigned workers;
+    std::vector<Chunk> chunks;
+    std::vector<char> done;
+    std::atomic<size_t> next_chunk;
+    std::mutex m;
+    std::condition_variable chunk_done;
+
+    // Cut the text at line boundaries into up to four chunks per worker, at least 1 MB each.
+    void split(const char* text, size_t length);
+
+    void work();
+
+    static void parse_chunk(Chunk& chunk);
+};
+
+// Parse a CNF file into flat storage, on all cores.
+SAT_API ParsedCnf load_cnf(const std::string& filename);
+
+// Pipelined loading: chunks are parsed on worker threads while the calling thread adds
+// the clauses of each finished chunk to the solver, building occurrence lists and
+// detecting units and duplicates as they arrive.
+SAT_API void load_cnf_pipelined(ChunkedDimacsParser& parser, DPLLSolver_DS& solver);
+SAT_API void load_cnf_pipelined(const std::string& filename, DPLLSolver_DS& solver);
+
+// Apply a parameter file: one "name = value" per line, '#' starts a comment. This is
+// the format tune.py writes and --print-config prints.
+SAT_API void load_solver_config(const std::string& path, DPLLSolver_DS& solver);
+
+// Write the solver's current parameters in load_solver_config() format.
+SAT_API void print_solver_config(std::ostream& out, const DPLLSolver_DS& solver);
+
+#endif
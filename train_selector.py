@@ -0,0 +1,123 @@
+import argparse
+import concurrent.futures
+import math
+import os
+import subprocess
+import tempfile
+from tune import run_config, training_instances
+
+# Train the nearest-neighbour algorithm selector that DPLL_CDCL_VSIDS loads with
+# --select. Every candidate configuration is run on every training instance (capped,
+# PAR2 cost), and the model stores each instance's features (--print-features) together
+# with those costs. See AlgorithmSelector in DPLL_CDCL_VSIDS.cpp for the file format.
+
+# Candidate configurations: parameter overrides on top of the solver defaults.
+CONFIGS = {
+    "vsids": {},
+    "lookahead": {"lookahead": 1},
+    "vsids-rapid": {"restart_base": 500, "restart_growth": 1.5},
+}
+
+
+def read_config_file(path):
+    # Parameters from a --config style file, e.g. one written by tune.py.
+    config = {}
+    with open(path) as f:
+        for line in f:
+            name, _, value = line.split("#")[0].partition("=")
+            if value.strip():
+                config[name.strip()] = float(value)
+    return config
+
+
+def instance_features(solver, cnf_path):
+    output = subprocess.check_output([solver, "--print-features", cnf_path], text=True)
+    features = []
+    for line in output.splitlines():
+        name, _, value = line.partition("=")
+        features.append((name.strip(), float(value)))
+    return features
+
+
+def train(args):
+    configs = dict(CONFIGS)
+    for spec in args.config:
+        name, _, path = spec.partition("=")
+        configs[name] = read_config_file(path)
+    instances = training_instances(args.instances)
+    if not instances:
+        raise SystemExit("No training instances found.")
+
+    features = {cnf: instance_features(args.solver, cnf) for cnf in instances}
+    names = [name for name, _ in features[instances[0]]]
+
+    costs = {}
+    with tempfile.TemporaryDirectory() as workdir, \
+            concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        paths = {}
+        for name, overrides in configs.items():
+            paths[name] = os.path.join(workdir, f"{name}.cfg")
+            with open(paths[name], "w") as f:
+                f.write("".join(f"{key} = {value}\n" for key, value in overrides.items()))
+        futures = {(cnf, name): pool.submit(run_config, args.solver, paths[name], cnf, args.timeout)
+                   for cnf in instances for name in configs}
+        for cnf in instances:
+            answers = set()
+            for name in configs:
+                seconds, answer = futures[(cnf, name)].result()
+                costs[(cnf, name)] = seconds if answer in ("SAT", "UNSAT") else 2 * args.timeout
+                if answer in ("SAT", "UNSAT"):
+                    answers.add(answer)
+            if len(answers) > 1:
+                print(f"warning: configurations disagree on {cnf}")
+            row = " ".join(f"{name}={costs[(cnf, name)]:.3f}" for name in configs)
+            print(f"{os.path.basename(cnf)}: {row}")
+
+    columns = list(zip(*[[value for _, value in features[cnf]] for cnf in instances]))
+    center = [sum(column) / len(column) for column in columns]
+    scale = [math.sqrt(sum((v - m) ** 2 for v in column) / len(column)) for column, m in zip(columns, center)]
+
+    with open(args.output, "w") as f:
+        f.write(f"# Trained by train_selector.py on {len(instances)} instances, cap {args.timeout}s.\n")
+        f.write("features " + " ".join(names) + "\n")
+        f.write("center " + " ".join(f"{v:.6g}" for v in center) + "\n")
+        f.write("scale " + " ".join(f"{v:.6g}" for v in scale) + "\n")
+        f.write(f"k {args.k}\n")
+        for name, overrides in configs.items():
+            f.write(" ".join(["config", name] + [f"{key}={value:g}" for key, value in overrides.items()]) + "\n")
+        for cnf in instances:
+            f.write(f"# {os.path.basename(cnf)}\n")
+            values = [value for _, value in features[cnf]] + [costs[(cnf, name)] for name in configs]
+            f.write("point " + " ".join(f"{v:.6g}" for v in values) + "\n")
+
+    # Leave-one-out check: total cost of the selector's first choice against each
+    # single configuration and the per-instance oracle.
+    total = {name: sum(costs[(cnf, name)] for cnf in instances) for name in configs}
+    chosen = 0.0
+    for cnf in instances:
+        others = [c for c in instances if c != cnf]
+        def distance(other):
+            return sum(((a - b) / (s or 1)) ** 2
+                       for (_, a), (_, b), s in zip(features[cnf], features[other], scale))
+        nearest = sorted(others, key=distance)[:args.k]
+        def score(name):
+            return sum(math.log((costs[(o, name)] + 0.01) / (min(costs[(o, n)] for n in configs) + 0.01))
+                       for o in nearest)
+        chosen += costs[(cnf, min(configs, key=score))]
+    oracle = sum(min(costs[(cnf, name)] for name in configs) for cnf in instances)
+    print("Total PAR2 seconds: " + ", ".join(f"{name} {value:.2f}" for name, value in total.items()) +
+          f", selector (leave-one-out) {chosen:.2f}, oracle {oracle:.2f}")
+    print(f"Wrote {args.output}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Train the DPLL_CDCL_VSIDS algorithm selector.")
+    parser.add_argument("instances", nargs="+", help="training CNF files, globs or directories")
+    parser.add_argument("--solver", default="./DPLL_CDCL_VSIDS")
+    parser.add_argument("-o", "--output", default="selector.model")
+    parser.add_argument("--config", action="append", default=[], metavar="NAME=FILE",
+                        help="add a candidate configuration from a parameter file (e.g. from tune.py)")
+    parser.add_argument("--timeout", type=float, default=10.0, help="cap in seconds per run")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="concurrent solver runs")
+    parser.add_argument("-k", type=int, default=5, help="neighbours consulted per prediction")
+    train(parser.parse_args())
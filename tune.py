@@ -0,0 +1,257 @@
+import argparse
+import concurrent.futures
+import glob
+import math
+import os
+import random
+import re
+import subprocess
+import tempfile
+import time
+
+# Automatic parameter tuning for DPLL_CDCL_VSIDS by iterated racing.
+#
+# Each iteration races a population of configurations over the training instances in
+# a shuffled order. After every instance the candidates are ranked on it, and those
+# whose rank sum falls significantly behind the leader are dropped, so poor settings
+# stop costing solver runs early. The survivors seed the next iteration, whose new
+# candidates are sampled around them. All runs of one race step execute concurrently.
+# Each run is capped, and a capped run costs twice the cap (PAR2).
+#
+# The solver lists its parameters and their defaults with --print-config, and it loads
+# the emitted file with --config.
+
+# Search space per parameter: (low, high, kind). "log" samples on a log scale, "int"
+# rounds to an integer, "bool" is 0 or 1. Parameters the solver reports that are not
+# listed here keep their default value.
+PARAMETER_SPACE = {
+    "decay_factor": (0.5, 1.0, "float"),
+    "conflict_weight": (0.01, 10.0, "log"),
+    "decay_interval": (1, 200, "int"),
+    "learned_clause_limit_percentage": (5, 200, "int"),
+    "max_learned_clause_len": (2, 50, "int"),
+    "restart_base": (100, 50000, "logint"),
+    "restart_growth": (1.1, 4.0, "float"),
+    "inprocess_effort": (0.0, 0.5, "float"),
+    "lookahead": (0, 1, "bool"),
+    "decompose": (0, 1, "bool"),
+    "reorder": (0, 1, "bool"),
+}
+
+
+def solver_defaults(solver):
+    output = subprocess.check_output([solver, "--print-config"], text=True)
+    defaults = {}
+    for line in output.splitlines():
+        name, _, value = line.partition("=")
+        if value.strip():
+            defaults[name.strip()] = float(value)
+    return defaults
+
+
+def clamp(name, value):
+    low, high, kind = PARAMETER_SPACE[name]
+    value = min(max(value, low), high)
+    if kind in ("int", "logint", "bool"):
+        value = int(round(value))
+    return value
+
+
+def sample_uniform(defaults, rng):
+    config = dict(defaults)
+    for name in defaults:
+        if name not in PARAMETER_SPACE:
+            continue
+        low, high, kind = PARAMETER_SPACE[name]
+        if kind in ("log", "logint"):
+            value = math.exp(rng.uniform(math.log(low), math.log(high)))
+        else:
+            value = rng.uniform(low, high)
+        config[name] = clamp(name, value)
+    return config
+
+
+def sample_near(parent, rng, spread):
+    # Perturb each tuned parameter of an elite configuration; spread (a fraction of the
+    # range, or of the log range) shrinks as the iterations progress.
+    config = dict(parent)
+    for name in parent:
+        if name not in PARAMETER_SPACE:
+            continue
+        low, high, kind = PARAMETER_SPACE[name]
+        if kind == "bool":
+            if rng.random() < spread:
+                config[name] = 1 - int(parent[name])
+        elif kind in ("log", "logint"):
+            width = math.log(high) - math.log(low)
+            value = math.exp(math.log(max(parent[name], low)) + rng.gauss(0, spread * width))
+            config[name] = clamp(name, value)
+        else:
+            value = parent[name] + rng.gauss(0, spread * (high - low))
+            config[name] = clamp(name, value)
+    return config
+
+
+def format_config(config):
+    return "".join(f"{name} = {value}\n" for name, value in config.items())
+
+
+def run_config(solver, config_path, cnf_path, cap):
+    # Wall-clock seconds of one capped run and its answer (SAT, UNSAT, TIMEOUT or ERROR).
+    start = time.monotonic()
+    try:
+        output = subprocess.run([solver, "--config", config_path, "--time-limit", str(cap), cnf_path],
+                                stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                text=True, timeout=cap + 5).stdout
+    except subprocess.TimeoutExpired:
+        return cap, "TIMEOUT"
+    elapsed = time.monotonic() - start
+    match = re.search(r"RESULT:\s+(SAT|UNSAT|UNKNOWN)", output)
+    if not match:
+        return elapsed, "ERROR"
+    if match.group(1) == "UNKNOWN" or elapsed > cap:
+        return cap, "TIMEOUT"
+    return elapsed, match.group(1)
+
+
+class Race:
+    def __init__(self, solver, cap, jobs, workdir):
+        self.solver = solver
+        self.cap = cap
+        self.pool = concurrent.futures.ThreadPoolExecutor(max_workers=jobs)
+        self.workdir = workdir
+        self.answers = {}        # instance -> SAT/UNSAT seen so far, to catch wrong answers
+        self.runs = 0
+        self.config_files = {}
+
+    def config_file(self, config):
+        text = format_config(config)
+        if text not in self.config_files:
+            path = os.path.join(self.workdir, f"config{len(self.config_files)}.cfg")
+            with open(path, "w") as f:
+                f.write(text)
+            self.config_files[text] = path
+        return self.config_files[text]
+
+    def cost(self, instance, seconds, answer):
+        if answer in ("SAT", "UNSAT"):
+            known = self.answers.setdefault(instance, answer)
+            if known == answer:
+                return seconds
+            print(f"  warning: conflicting answers on {instance}")
+        return 2 * self.cap
+
+    def race(self, candidates, order, min_instances, max_runs):
+        # Race the candidates over the instances in order; return (config, mean cost)
+        # of the survivors, best first.
+        alive = list(range(len(candidates)))
+        costs = [[] for _ in candidates]
+        for step, instance in enumerate(order):
+            if (len(alive) <= 1 and step >= min_instances) or self.runs + len(alive) > max_runs:
+                break
+            paths = [self.config_file(candidates[c]) for c in alive]
+            futures = [self.pool.submit(run_config, self.solver, path, instance, self.cap) for path in paths]
+            for c, future in zip(alive, futures):
+                seconds, answer = future.result()
+                costs[c].append(self.cost(instance, seconds, answer))
+            self.runs += len(alive)
+            if step + 1 >= min_instances and len(alive) > 1:
+                alive = self.eliminate(alive, costs, step + 1)
+        ranked = sorted(alive, key=lambda c: sum(costs[c]) / max(1, len(costs[c])))
+        return [(candidates[c], sum(costs[c]) / max(1, len(costs[c]))) for c in ranked]
+
+    @staticmethod
+    def eliminate(alive, costs, n):
+        # Friedman-style test on the rank sums over the n instances seen: a candidate is
+        # dropped when its rank sum exceeds the leader's by more than the critical
+        # difference at roughly the 95% level.
+        k = len(alive)
+        rank_sum = {c: 0.0 for c in alive}
+        for i in range(n):
+            ordered = sorted(alive, key=lambda c: costs[c][i])
+            j = 0
+            while j < k:
+                tied = j
+                while tied + 1 < k and costs[ordered[tied + 1]][i] == costs[ordered[j]][i]:
+                    tied += 1
+                for t in range(j, tied + 1):
+                    rank_sum[ordered[t]] += (j + tied) / 2 + 1
+                j = tied + 1
+        best = min(rank_sum.values())
+        critical = 1.96 * math.sqrt(n * k * (k + 1) / 6)
+        return [c for c in alive if rank_sum[c] - best <= critical]
+
+
+def training_instances(patterns):
+    files = []
+    for pattern in patterns:
+        if os.path.isdir(pattern):
+            pattern = os.path.join(pattern, "*.cnf")
+        files.extend(sorted(glob.glob(pattern)))
+    return files
+
+
+def tune(args):
+    rng = random.Random(args.seed)
+    instances = training_instances(args.instances)
+    if not instances:
+        raise SystemExit("No training instances found.")
+    defaults = solver_defaults(args.solver)
+    fixed = [name for name in defaults if name not in PARAMETER_SPACE]
+    if fixed:
+        print("Keeping defaults for parameters without a search range: " + ", ".join(fixed))
+
+    with tempfile.TemporaryDirectory() as workdir:
+        race = Race(args.solver, args.timeout, args.jobs, workdir)
+        elites = [(defaults, None)]
+        for iteration in range(args.iterations):
+            if race.runs >= args.budget:
+                break
+            spread = 0.3 * (1 - iteration / args.iterations) + 0.05
+            candidates = [config for config, _ in elites]
+            while len(candidates) < args.population:
+                if iteration == 0 or rng.random() < 0.2:
+                    candidates.append(sample_uniform(defaults, rng))
+                else:
+                    parent = rng.choice(elites)[0]
+                    candidates.append(sample_near(parent, rng, spread))
+            order = instances[:]
+            rng.shuffle(order)
+            survivors = race.race(candidates, order, args.min_instances, args.budget)
+            elites = survivors[:args.elites]
+            print(f"Iteration {iteration + 1}: {len(candidates)} candidates, {len(survivors)} survived, "
+                  f"best mean cost {elites[0][1]:.3f}s, {race.runs} runs so far")
+
+        # Final comparison of the winner and the defaults on every training instance.
+        best = elites[0][0]
+        final = race.race([best, defaults], instances, len(instances), race.runs + 2 * len(instances))
+        scores = {format_config(config): cost for config, cost in final}
+        best_cost = scores.get(format_config(best), float("nan"))
+        default_cost = scores.get(format_config(defaults), float("nan"))
+        race.pool.shutdown()
+
+    if default_cost < best_cost:
+        print("The defaults were not beaten; writing them unchanged.")
+        best, best_cost = defaults, default_cost
+    with open(args.output, "w") as f:
+        f.write(f"# Tuned by tune.py on {len(instances)} instances, {race.runs} runs, cap {args.timeout}s.\n")
+        f.write(f"# Mean PAR2 seconds: tuned {best_cost:.4f}, defaults {default_cost:.4f}.\n")
+        f.write(format_config(best))
+    print(f"Wrote {args.output} (mean PAR2 {best_cost:.4f}s against {default_cost:.4f}s for the defaults)")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Tune DPLL_CDCL_VSIDS parameters by iterated racing.")
+    parser.add_argument("instances", nargs="+", help="training CNF files, globs or directories")
+    parser.add_argument("--solver", default="./DPLL_CDCL_VSIDS")
+    parser.add_argument("-o", "--output", default="tuned.cfg")
+    parser.add_argument("--timeout", type=float, default=10.0, help="cap in seconds per run")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="concurrent solver runs")
+    parser.add_argument("--budget", type=int, default=2000, help="maximum number of solver runs")
+    parser.add_argument("--iterations", type=int, default=5)
+    parser.add_argument("--population", type=int, default=16, help="candidates per iteration")
+    parser.add_argument("--elites", type=int, default=4, help="survivors carried to the next iteration")
+    parser.add_argument("--min-instances", type=int, default=5,
+                        help="instances every candidate runs before eliminations start")
+    parser.add_argument("--seed", type=int, default=0)
+    tune(parser.parse_args())